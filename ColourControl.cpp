@@ -1,21 +1,40 @@
 #include "Globals.h"
 
-static void isrTimer()
+// Colours the screen can be set to before the changing colour and the effects
+static const byte colourCount = 0x07;
+
+// Milliseconds between steps of the changing colour and of the effects, whatever the refresh runs at
+static const uint32_t millisColourStep = 60000;
+static const uint32_t millisEffectStep = 1000 / 25;
+
+// Steps round the hue wheel, 16 between each of the six primary and secondary colours
+static const int hueSteps = 96;
+
+//-----------------
+// Function: hueRgb
+//-----------------
+static uint16_t hueRgb(int hue)
 {
-  static byte colour = 0x00;
+  int frac = hue % 16;
 
-  colour++;
-  if(colour > 0x06)
+  // 4 bit channels as 0x0RGB
+  switch((hue / 16) % 6)
   {
-    colour = 0x00;
+    default:
+    case 0: return 0x0F00 | (frac << 4);
+    case 1: return ((15 - frac) << 8) | 0x00F0;
+    case 2: return 0x00F0 | frac;
+    case 3: return ((15 - frac) << 4) | 0x000F;
+    case 4: return (frac << 8) | 0x000F;
+    case 5: return 0x0F00 | (15 - frac);
   }
-
-  dmd.SetColour(colour);
 }
 
 ColourControl::ColourControl()
 {
     m_colour = 0x00;
+    m_millisStart = 0;
+    m_step = 0;
 }
 
 void ColourControl::SetColour(byte colour)
@@ -23,16 +42,75 @@ void ColourControl::SetColour(byte colour)
   if(colour != m_colour)
   {
     m_colour = colour;
-    if(m_colour == 0x07)
+    m_millisStart = millis();
+    m_step = 0xFFFFFFFF;
+
+    // Effects modulate a white screen, a plain colour has no modulation
+    dmd.ClearGains();
+    if(m_colour < colourCount)
     {
-      // Start timer
-      m_timerColour.begin(isrTimer, 60000000);
+      dmd.SetColour(m_colour);
     }
     else
     {
-      // Stop timer
-      m_timerColour.end();
-      dmd.SetColour(m_colour);
+      dmd.SetColour(colourCount - 1);
     }
+
+    Update();
+
+    // The frame on screen takes up the gains without waiting to be drawn again
+    dmd.Recompile();
+  }
+}
+
+void ColourControl::Update()
+{
+  // Paced by the clock, steps only change the colour or the modulation tables
+  uint32_t millisElapsed = millis() - m_millisStart;
+  uint32_t step;
+
+  switch(m_colour)
+  {
+    case Config::CFG_DC_CHANGE:
+      // Next colour every minute
+      step = millisElapsed / millisColourStep;
+      if(step != m_step)
+      {
+        m_step = step;
+        dmd.SetColour(step % colourCount);
+      }
+      break;
+
+    case Config::CFG_DC_RAINBOW:
+      // Hue wheel across the columns, sweeping along
+      step = millisElapsed / millisEffectStep;
+      if(step != m_step)
+      {
+        m_step = step;
+        for(int x = 0; x < DmdWidth; x++)
+        {
+          dmd.SetColumnGain(x, hueRgb(((x * hueSteps) / DmdWidth + step) % hueSteps));
+        }
+        dmd.Recompile();
+      }
+      break;
+
+    case Config::CFG_DC_GRADIENT:
+      // A sixth of the hue wheel from top to bottom, drifting round
+      step = millisElapsed / (millisEffectStep * 4);
+      if(step != m_step)
+      {
+        m_step = step;
+        for(int y = 0; y < DmdHeight; y++)
+        {
+          dmd.SetRowGain(y, hueRgb(((y * (hueSteps / 6)) / DmdHeight + step) % hueSteps));
+        }
+        dmd.Recompile();
+      }
+      break;
+
+    default:
+      // Plain colour
+      break;
   }
 }
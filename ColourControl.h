@@ -1,17 +1,18 @@
 #ifndef __COLOURCONTROL_H__
 
 #include <Arduino.h>
-#include <IntervalTimer.h>
 
 class ColourControl
 {
 public:
     ColourControl();
     void SetColour(byte colour);
+    void Update();
 
 private:
     byte m_colour;
-    IntervalTimer m_timerColour;
+    uint32_t m_millisStart;
+    uint32_t m_step;
 };
 
 #endif
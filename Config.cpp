@@ -17,7 +17,7 @@ Config::Config()
     cfgItems.cfgDST = CFG_DST_OFF;
     cfgItems.cfgTimeFormat = CFG_TF_24HOUR;
     cfgItems.cfgTimeCorrect = 0;
-    cfgItems.cfgBrightness = 10;
+    cfgItems.cfgBrightness = 33;
     cfgItems.cfgClockDelay = CFG_CD_5SECS;
     strcpy(cfgItems.cfgClockFont, "STANDARD");
     cfgItems.cfgDotColour = CFG_DC_RED;
@@ -27,6 +27,8 @@ Config::Config()
     cfgItems.cfgBtnMap = CFG_BM_NORMAL;
     cfgItems.cfgSleepTime = 0;
     cfgItems.cfgWakeTime = 0;
+    cfgItems.cfgGamma = CFG_GM_LINEAR;
+    cfgItems.cfgPlanes = CFG_PL_4;
 
     setValues();
 
@@ -94,10 +96,25 @@ bool Config::readEeprom()
 
   // Read the config item count
   address += readBytes(address, (byte *)&cfgCntItems, sizeof(cfgCntItems));
-  if(cfgCntItems == CntItems)
+  if(cfgCntItems >= CntItemsColumnBrightness && cfgCntItems <= CntItems)
   {
     // Read the remaining items
     readBytes(address, (byte*)&cfgItems, sizeof(cfgItems));    
+    if(cfgCntItems == CntItemsColumnBrightness)
+    {
+      // The display was lit for the whole plane time, about half the row at the default plane times, and the
+      // shift's first brightness columns of 128 after, so about the same share of the plane's on time
+      cfgItems.cfgBrightness = 31 + (cfgItems.cfgBrightness / 4);
+    }
+    if(cfgCntItems <= CntItemsGammaPlanes)
+    {
+      // The planes the gamma curve took
+      cfgItems.cfgPlanes = (cfgItems.cfgGamma == CFG_GM_LINEAR ? CFG_PL_4 : CFG_PL_6);
+    }
+    if(cfgCntItems != CntItems)
+    {
+      writeEeprom();
+    }
     setValues();
     ret = true;
   }
@@ -18,6 +18,8 @@ typedef struct tagConfigItems
     int cfgBtnMap;
     time_t cfgSleepTime;
     time_t cfgWakeTime;
+    int cfgGamma;
+    int cfgPlanes;
 
 } ConfigItems;
 
@@ -38,7 +40,13 @@ class Config
     void setValues();
 
   public:
-    static const int CntItems = 13;
+    static const int CntItems = 16;
+
+    // Saved before brightness was a share of each plane's on time, it was the column the shift darkened at
+    static const int CntItemsColumnBrightness = 14;
+
+    // Saved before the plane count was an item of its own, it went with the gamma curve
+    static const int CntItemsGammaPlanes = 15;
 
   // DST
   enum {
@@ -67,6 +75,9 @@ class Config
   // DOT COLOUR
   enum {
     CFG_DC_RED = 0,
+    CFG_DC_CHANGE = 7,
+    CFG_DC_RAINBOW,
+    CFG_DC_GRADIENT,
   };
 
   // SHOW BRAND
@@ -90,6 +101,21 @@ class Config
     CFG_BM_REVERSE
   } ;
 
+  // GAMMA
+  enum {
+    CFG_GM_LINEAR = 0,
+    CFG_GM_18,
+    CFG_GM_22,
+    CFG_GM_28,
+  } ;
+
+  // PLANES
+  enum {
+    CFG_PL_4 = 0,
+    CFG_PL_5,
+    CFG_PL_6,
+  } ;
+
   public:
     Config();
     const ConfigItems& GetCfgItems();
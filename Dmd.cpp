@@ -3,28 +3,107 @@
 
 #include "Globals.h"
 
+// Default plane count and timings
+const int planesDefault = 4;
+const uint16_t microsPlanesDefault[planesDefault] = { 1, 2, 30, 45};
+
+// Load governor, isr duty in percent above which the refresh is eased and below which it is restored
+const uint32_t dutyGovernHigh = 60;
+const uint32_t dutyGovernLow = 30;
+
+// Once down to the fewest planes each further step stretches the plane times by a quarter
+const int stepsGovernStretch = 4;
+
 // Funtion Prototypes
 extern "C"
 {
-static void isrDmdType0();
-static void isrDmdType1();
+static void isrDmd();
 }
+static void pinPort(int pin, volatile uint32_t *&regSet, volatile uint32_t *&regClear, uint32_t& mask);
+static inline byte gainLevel(byte level, uint16_t gainRow, uint16_t gainCol, int channel);
 
 //----------------------
 // Function: Constructor
 //----------------------
-Dmd::Dmd()
+template<class Pinout>
+Dmd<Pinout>::Dmd()
 {
-  // Set buffer pointers
-  bufferActive = &buffer1;
-  bufferInactive = &buffer2;
-  bufferInUse = &buffer1;
+  // Empty frame queue
+  idxHead = 0;
+  idxTail = 0;
+  microsLastDue = 0;
+  microsRefreshStart = 0;
+  microsRefreshPeriod = 0;
+  cyclesTimer = 0;
+  cyclesTimerRefresh = 0;
+  cyclesIrqOff = 0;
+  cyclesIrqOffSecond = 0;
+  memset(&stats, 0, sizeof(stats));
+  memset(&statsSecond, 0, sizeof(statsSecond));
+  microsStatsStart = 0;
+  cntRefreshesStats = 0;
+  cntStats = 0;
+  cntPresented = 0;
+  cntRefreshes = 0;
+  callbackRefresh = NULL;
 
   // Init other variables
   frame = 0;
   row = 0;
   brightness = 0;
+  dutyEnable = 1.0 / 64;
+  memset(ticksEnable, 0, sizeof(ticksEnable));
   colour = 0x00;
+  dmdType = 0;
+  layout.cntPorts = 0;
+  shiftRow = NULL;
+
+  // Empty command queue
+  idxCommandHead = 0;
+  idxCommandTail = 0;
+  isActive = false;
+  bankWords = 0;
+  bankWordsQueued = 0;
+
+  // Default plane timings, dot levels map straight on to the planes
+  cntPlanes = planesDefault;
+  memset(microsPlanes, 0, sizeof(microsPlanes));
+  memcpy(microsPlanes, microsPlanesDefault, sizeof(microsPlanesDefault));
+  memset(microsOn, 0, sizeof(microsOn));
+  for(int plane = 0; plane < cntPlanes; plane++)
+  {
+    microsOn[plane] = microsPlanes[plane];
+  }
+  microsPlaneFloor = 1;
+  gamma = 1.0;
+  CompileLevelPlanes();
+
+  // Order the dots are shifted out in
+  CompileScanMap();
+
+  // No colour modulation
+  ClearGains();
+
+  // Governor starts with the refresh as asked for
+  cntPlanesTarget = cntPlanes;
+  microsTotalTarget = 0;
+  for(int plane = 0; plane < cntPlanes; plane++)
+  {
+    microsTotalTarget += microsPlanes[plane];
+  }
+  levelGovern = 0;
+  cntStatsGovern = 0;
+  cntGovernChanges = 0;
+
+  // Blank frames to start with, all on the first planes of the pool
+  memset(planes, 0, sizeof(planes));
+  for(int slot = 0; slot < DmdQueueSlots; slot++)
+  {
+    buffers[slot].cntPlanes = cntPlanes;
+    memcpy(buffers[slot].microsPlanes, microsPlanes, sizeof(microsPlanes));
+    memcpy(buffers[slot].microsOn, microsOn, sizeof(microsOn));
+    buffers[slot].posPlanes = 0;
+  }
   
   // Set interrupt priority
   timerDmd.priority(200);
@@ -33,83 +112,144 @@ Dmd::Dmd()
 //---------------------
 // Function: Initialise
 //---------------------
-void Dmd::Initialise(int pinEN, int pinR1, int pinR2, int pinG1, int pinG2, int pinB1, int pinB2, int pinLA, int pinLB, int pinLC, int pinLD, int pinLT, int pinSK)
+template<class Pinout>
+void Dmd<Pinout>::Initialise()
 {
   // Screen pin outputs
-  pinMode(pinEN, OUTPUT);
-  pinMode(pinR1, OUTPUT);
-  pinMode(pinR2, OUTPUT);
-  pinMode(pinG1, OUTPUT);
-  pinMode(pinG2, OUTPUT);
-  #ifdef HUB75
-  pinMode(pinB1, OUTPUT);
-  pinMode(pinB2, OUTPUT);
-  #endif
-  pinMode(pinLA, OUTPUT);
-  pinMode(pinLB, OUTPUT);
-  pinMode(pinLC, OUTPUT);
-  pinMode(pinLD, OUTPUT);
-  pinMode(pinLT, OUTPUT);
-  pinMode(pinSK, OUTPUT);
+  pinMode(Pinout::pinEN, OUTPUT);
+  pinMode(Pinout::pinR1, OUTPUT);
+  pinMode(Pinout::pinR2, OUTPUT);
+  pinMode(Pinout::pinG1, OUTPUT);
+  pinMode(Pinout::pinG2, OUTPUT);
+  if(Pinout::hasBlue)
+  {
+    pinMode(Pinout::pinB1, OUTPUT);
+    pinMode(Pinout::pinB2, OUTPUT);
+  }
+  if(DmdChains > 1)
+  {
+    pinMode(Pinout::pinR3, OUTPUT);
+    pinMode(Pinout::pinR4, OUTPUT);
+    pinMode(Pinout::pinG3, OUTPUT);
+    pinMode(Pinout::pinG4, OUTPUT);
+    if(Pinout::hasBlue)
+    {
+      pinMode(Pinout::pinB3, OUTPUT);
+      pinMode(Pinout::pinB4, OUTPUT);
+    }
+  }
+  pinMode(Pinout::pinLA, OUTPUT);
+  pinMode(Pinout::pinLB, OUTPUT);
+  pinMode(Pinout::pinLC, OUTPUT);
+  pinMode(Pinout::pinLD, OUTPUT);
+  pinMode(Pinout::pinLT, OUTPUT);
+  pinMode(Pinout::pinSK, OUTPUT);
 
   //Set all to LOW
-  digitalWrite(pinEN, LOW);
-  digitalWrite(pinR1, LOW);
-  digitalWrite(pinR2, LOW);
-  digitalWrite(pinG1, LOW);
-  digitalWrite(pinG2, LOW);
-  #ifdef HUB75
-  digitalWrite(pinB1, LOW);
-  digitalWrite(pinB2, LOW);
-  #endif
-  digitalWrite(pinLA, LOW);
-  digitalWrite(pinLB, LOW);
-  digitalWrite(pinLC, LOW);
-  digitalWrite(pinLD, LOW);
-  digitalWrite(pinLT, LOW);
-  digitalWrite(pinSK, LOW);
-
-  // Store the pin assignments
-  this->pinEN = pinEN;
-  this->pinR1 = pinR1;
-  this->pinR2 = pinR2;
-  this->pinG1 = pinG1;
-  this->pinG2 = pinG2;
-  this->pinB1 = pinB1;
-  this->pinB2 = pinB2;
-  this->pinLA = pinLA;
-  this->pinLB = pinLB;
-  this->pinLC = pinLC;
-  this->pinLD = pinLD;
-  this->pinLT = pinLT;
-  this->pinSK = pinSK;  
+  digitalWrite(Pinout::pinEN, LOW);
+  digitalWrite(Pinout::pinR1, LOW);
+  digitalWrite(Pinout::pinR2, LOW);
+  digitalWrite(Pinout::pinG1, LOW);
+  digitalWrite(Pinout::pinG2, LOW);
+  if(Pinout::hasBlue)
+  {
+    digitalWrite(Pinout::pinB1, LOW);
+    digitalWrite(Pinout::pinB2, LOW);
+  }
+  if(DmdChains > 1)
+  {
+    digitalWrite(Pinout::pinR3, LOW);
+    digitalWrite(Pinout::pinR4, LOW);
+    digitalWrite(Pinout::pinG3, LOW);
+    digitalWrite(Pinout::pinG4, LOW);
+    if(Pinout::hasBlue)
+    {
+      digitalWrite(Pinout::pinB3, LOW);
+      digitalWrite(Pinout::pinB4, LOW);
+    }
+  }
+  digitalWrite(Pinout::pinLA, LOW);
+  digitalWrite(Pinout::pinLB, LOW);
+  digitalWrite(Pinout::pinLC, LOW);
+  digitalWrite(Pinout::pinLD, LOW);
+  digitalWrite(Pinout::pinLT, LOW);
+  digitalWrite(Pinout::pinSK, LOW);
+
+  // Enable the cycle counter for the probes
+  ARM_DEMCR |= ARM_DEMCR_TRCENA;
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
+  // Describe the GPIO ports for the scanline compiler
+  CompilePortLayout();
+  CompilePortWords(bankWords.load());
 }
 
 //----------------
 // Function: Start
 //----------------
-void Dmd::Start()
+template<class Pinout>
+void Dmd<Pinout>::Start()
 {
-  // Start the interrupts
-  timerDmd.begin(dmdType == 1 ? isrDmdType1 : isrDmdType0, 1);
+  // Select the shift kernel unrolled for the number of ports in use
+  switch(layout.cntPorts)
+  {
+    case 1:
+      shiftRow = &Dmd::template ShiftRow<1>;
+      break;
+    case 2:
+      shiftRow = &Dmd::template ShiftRow<2>;
+      break;
+    case 3:
+      shiftRow = &Dmd::template ShiftRow<3>;
+      break;
+    case 4:
+      shiftRow = &Dmd::template ShiftRow<4>;
+      break;
+    default:
+      shiftRow = &Dmd::template ShiftRow<DmdPortsMax>;
+      break;
+  }
+
+  // Output enable driver and the on times of the frame on screen
+  Enable::Begin();
+  CompileEnableTicks();
+
+  // Start the interrupts, the first period is also the one after the first row
+  timerDmd.begin(isrDmd, buffers[(byte)(idxHead.load() - 1) % DmdQueueSlots].microsPlanes[frame]);
+  isActive = true;
 }
 
 //---------------
 // Function: Stop
 //---------------
-void Dmd::Stop()
+template<class Pinout>
+void Dmd<Pinout>::Stop()
 {
   // Stop the interrupts
   timerDmd.end();
+  isActive = false;
+
+  // Nothing is left to apply queued changes, do so now
+  ApplyCommands();
 
-  // Disable display
-  digitalWriteFast(pinEN, HIGH);
+  // Disable display, the pin is a GPIO again
+  Enable::End();
+}
+
+//-------------------
+// Function: IsActive
+//-------------------
+template<class Pinout>
+bool Dmd<Pinout>::IsActive()
+{
+  return isActive;
 }
 
 //------------------------
 // Function: SetBrightness
 //------------------------
-bool Dmd::SetBrightness(int set)
+template<class Pinout>
+bool Dmd<Pinout>::SetBrightness(int set)
 {
   bool ret ;
 
@@ -121,9 +261,9 @@ bool Dmd::SetBrightness(int set)
   }
   else
   {
-    // Set brightness
+    // Set brightness, the isr takes it up at the start of the next refresh
     brightness = set;
-    ret = true;
+    ret = QueueCommand(DmdCommandBrightness, brightness);
   }
 
   return ret;
@@ -132,7 +272,8 @@ bool Dmd::SetBrightness(int set)
 //------------------------
 // Function: GetBrightness
 //------------------------
-int Dmd::GetBrightness()
+template<class Pinout>
+int Dmd<Pinout>::GetBrightness()
 {
   return brightness;
 }
@@ -140,7 +281,8 @@ int Dmd::GetBrightness()
 //--------------------
 // Function: SetColour
 //--------------------
-bool Dmd::SetColour(byte set)
+template<class Pinout>
+bool Dmd<Pinout>::SetColour(byte set)
 {
   bool ret ;
 
@@ -152,8 +294,9 @@ bool Dmd::SetColour(byte set)
   }
   else
   {
-    // Set brightness
+    // Set colour, the isr switches to port words for it at the start of the next refresh
     colour = set;
+    QueuePortWords();
     ret = true;
   }
 
@@ -163,389 +306,1147 @@ bool Dmd::SetColour(byte set)
 //--------------------
 // Function: GetColour
 //--------------------
-byte Dmd::GetColour()
+template<class Pinout>
+byte Dmd<Pinout>::GetColour()
 {
   return colour;  
 }
 
-//-------------------
-// Function: SetFrame
-//-------------------
-void Dmd::SetFrame(DmdFrame& source)
+//----------------------------
+// Function: AcquireBackBuffer
+//----------------------------
+template<class Pinout>
+DmdFrame& Dmd<Pinout>::AcquireBackBuffer()
+{
+  // Frame is left as last presented, the renderer clears it as required
+  // Mono dots of a colour frame are drawn in the screen colour
+  frameBack.SetTint((colour + 1) & DmdTintWhite);
+
+  return frameBack;
+}
+
+//------------------
+// Function: Present
+//------------------
+template<class Pinout>
+bool Dmd<Pinout>::Present()
+{
+  // Due straight away
+  return PresentAt(micros());
+}
+
+//--------------------
+// Function: PresentAt
+//--------------------
+template<class Pinout>
+bool Dmd<Pinout>::PresentAt(uint32_t microsDue)
+{
+  // Compiled straight from the back buffer, which the renderer keeps drawing into
+  return QueueFrame(frameBack, microsDue);
+}
+
+//--------------------
+// Function: Recompile
+//--------------------
+template<class Pinout>
+bool Dmd<Pinout>::Recompile()
+{
+  // Back buffer as the renderer last left it, due straight away, for gains changed on a frame not drawn again
+  return QueueFrame(frameBack, micros());
+}
+
+//---------------------
+// Function: SetRowGain
+//---------------------
+template<class Pinout>
+bool Dmd<Pinout>::SetRowGain(int y, uint16_t rgb)
+{
+  // Check range
+  if(y < 0 || y >= DmdHeight)
+  {
+    // Out of range, return
+    return false;
+  }
+
+  // Takes effect when the next frame is compiled
+  gainRows[y] = rgb & 0x0FFF;
+  isModulated |= (gainRows[y] != 0x0FFF);
+
+  return true;
+}
+
+//------------------------
+// Function: SetColumnGain
+//------------------------
+template<class Pinout>
+bool Dmd<Pinout>::SetColumnGain(int x, uint16_t rgb)
 {
-  DmdFrameRaw *bufferTemp;
+  // Check range
+  if(x < 0 || x >= DmdWidth)
+  {
+    // Out of range, return
+    return false;
+  }
+
+  // Takes effect when the next frame is compiled
+  gainCols[x] = rgb & 0x0FFF;
+  isModulated |= (gainCols[x] != 0x0FFF);
+
+  return true;
+}
+
+//---------------------
+// Function: ClearGains
+//---------------------
+template<class Pinout>
+void Dmd<Pinout>::ClearGains()
+{
+  // Full gain everywhere, frames compile without modulation
+  for(int y = 0; y < DmdHeight; y++)
+  {
+    gainRows[y] = 0x0FFF;
+  }
+
+  for(int x = 0; x < DmdWidth; x++)
+  {
+    gainCols[x] = 0x0FFF;
+  }
+
+  isModulated = false;
+}
+
+//---------------------
+// Function: QueueFrame
+//---------------------
+template<class Pinout>
+bool Dmd<Pinout>::QueueFrame(DmdFrame& source, uint32_t microsDue)
+{
+  byte idxSlot = idxTail.load();
+  byte idxShown = idxHead.load() - 1;
+  int posPlanes;
+
+  // Queue full? All slots but the one on screen are waiting
+  if((byte)(idxSlot - idxShown) > DmdQueueSlots - 1)
+  {
+    return false;
+  }
+
+  // Ease or restore the refresh to the isr load before compiling with it
+  Govern();
+
+  // Planes follow on from the last frame queued, round the end of the pool and on from its start, so no room
+  // is left over there that a frame of more planes than the last would not fit in
+  const DmdScanlines& last = buffers[(byte)(idxSlot - 1) % DmdQueueSlots];
+
+  posPlanes = (last.posPlanes + last.cntPlanes) % (DmdQueuePlanes * 2);
+
+  // Pool full? The planes from the frame on screen's first to the new frame's last must fit, the isr only frees more
+  if((posPlanes + cntPlanes - buffers[idxShown % DmdQueueSlots].posPlanes + (DmdQueuePlanes * 2)) % (DmdQueuePlanes * 2) > DmdQueuePlanes)
+  {
+    return false;
+  }
+
+  // Frames are shown in the order presented, never before an earlier one
+  if((int32_t)(microsDue - microsLastDue) < 0)
+  {
+    microsDue = microsLastDue;
+  }
+  microsLastDue = microsDue;
 
-  // Copy the source frame to the inactive buffer
-  memcpy(bufferInactive->dots, source.frame.dots, sizeof(bufferInactive->dots));
+  // Compile the frame into scanlines in the tail slot
+  buffers[idxSlot % DmdQueueSlots].posPlanes = posPlanes;
+  CompileScanlines(source, &buffers[idxSlot % DmdQueueSlots]);
+  this->microsDue[idxSlot % DmdQueueSlots] = microsDue;
 
-  // Switch inactive to active
-  bufferTemp = bufferActive;  
-  bufferActive = bufferInactive;
-  bufferInactive = bufferTemp;
+  // Hand the slot over to the isr
+  idxTail.store(idxSlot + 1);
+
+  return true;
 }
 
 //-------------------
 // Function: WaitSync
 //-------------------
-bool Dmd::WaitSync(uint32_t timeout)
+template<class Pinout>
+bool Dmd<Pinout>::WaitSync(uint32_t timeout)
 {
-  // Wait until the current Active buffer has started to be used
-  while(bufferInUse == bufferInactive)
+  unsigned long microsStart = micros();
+
+  // Wait until the isr has taken every frame presented, timeout in microseconds, 0 is no timeout
+  while(idxHead.load() != idxTail.load())
   {
-    delayMicroseconds(1);
+    if(timeout != 0 && micros() - microsStart >= timeout)
+    {
+      // Timed out
+      return false;
+    }
   }
   
   return true;
 }
 
-//------------------
-// Function: IsrDmd0
-//------------------
-void Dmd::IsrDmdType0()
+//----------------------
+// Function: WaitRefresh
+//----------------------
+template<class Pinout>
+bool Dmd<Pinout>::WaitRefresh(uint32_t timeout)
 {
-  int isrDelay;
+  unsigned long microsStart = micros();
+  uint32_t cntStart = cntRefreshes.load();
 
-  // Disable the timer interrupt
-  timerDmd.end();
+  // Wait until the isr completes the next refresh cycle, timeout in microseconds, 0 is no timeout
+  while(cntRefreshes.load() == cntStart)
+  {
+    if(timeout != 0 && micros() - microsStart >= timeout)
+    {
+      // Timed out
+      return false;
+    }
 
-  // Update a Dmd row
-  isrDelay = UpdateRowType0();
+    yield();
+  }
 
-  // Set up next interrupt
-  timerDmd.begin(isrDmdType0, isrDelay);
+  return true;
 }
 
-//------------------
-// Function: IsrDmd1
-//------------------
-void Dmd::IsrDmdType1()
+//-----------------------------
+// Function: GetPresentedCount
+//-----------------------------
+template<class Pinout>
+uint32_t Dmd<Pinout>::GetPresentedCount()
 {
-  int isrDelay;
+  return cntPresented.load();
+}
 
-  // Disable the timer interrupt
-  timerDmd.end();
+//---------------------------
+// Function: GetRefreshCount
+//---------------------------
+template<class Pinout>
+uint32_t Dmd<Pinout>::GetRefreshCount()
+{
+  return cntRefreshes.load();
+}
+
+//-------------------------
+// Function: GetTimerCycles
+//-------------------------
+template<class Pinout>
+uint32_t Dmd<Pinout>::GetTimerCycles()
+{
+  // Cycles spent reprogramming the refresh timer over the last refresh
+  return cyclesTimerRefresh;
+}
+
+//--------------------------
+// Function: GetIrqOffCycles
+//--------------------------
+template<class Pinout>
+uint32_t Dmd<Pinout>::GetIrqOffCycles()
+{
+  // Longest time the isr held interrupts off for over the last second
+  return cyclesIrqOffSecond;
+}
+
+//-------------------
+// Function: GetStats
+//-------------------
+template<class Pinout>
+void Dmd<Pinout>::GetStats(DmdStats& get)
+{
+  // Isr profile over the last second
+  noInterrupts();
+  get = statsSecond;
+  interrupts();
+}
+
+//-----------------------------
+// Function: SetRefreshCallback
+//-----------------------------
+template<class Pinout>
+void Dmd<Pinout>::SetRefreshCallback(DMDREFRESHCALLBACK callback)
+{
+  callbackRefresh = callback;
+}
+
+//-----------------
+// Function: IsrDmd
+//-----------------
+template<class Pinout>
+void Dmd<Pinout>::IsrDmd()
+{
+  int isrDelay;
+  uint32_t cyclesStart;
+  uint32_t cyclesIsr = ARM_DWT_CYCCNT;
+  int plane = frame;
+  uint32_t microsSlot = buffers[(byte)(idxHead.load() - 1) % DmdQueueSlots].microsPlanes[plane];
 
   // Update a Dmd row
-  isrDelay = UpdateRowType1();
+  isrDelay = UpdateRow();
+
+  // The timer has already reloaded the period that follows this row, so program the one after the next row
+  // The running timer takes it as its next reload, there is no need to stop and restart it
+  cyclesStart = ARM_DWT_CYCCNT;
+  timerDmd.update(isrDelay);
+  cyclesTimer += ARM_DWT_CYCCNT - cyclesStart;
 
-  // Set up next interrupt
-  timerDmd.begin(isrDmdType1, isrDelay);
+  // Profile the row against the time it has before the next
+  ProfileRow(plane, ARM_DWT_CYCCNT - cyclesIsr, microsSlot);
 }
 
 //---------------------
 // Function: SetDmdType
 //---------------------
-void Dmd::SetDmdType(int dmdType)
+template<class Pinout>
+void Dmd<Pinout>::SetDmdType(int dmdType)
 {
   this->dmdType = dmdType;
+  QueuePortWords();
+}
+
+//--------------------
+// Function: SetPlanes
+//--------------------
+template<class Pinout>
+bool Dmd<Pinout>::SetPlanes(int set)
+{
+  // Check range
+  if(set < DmdPlanesMin || set > DmdPlanesMax)
+  {
+    // Out of range, return
+    return false;
+  }
+
+  // Keep the refresh rate asked for, sharing its total time between the new planes, not the whole microseconds
+  // the last planes were rounded up to or the governor stretched them to
+  levelGovern = 0;
+
+  cntPlanes = set;
+  DistributePlaneTimings(microsTotalTarget);
+  CompileLevelPlanes();
+
+  // New target for the governor
+  cntPlanesTarget = cntPlanes;
+
+  return true;
+}
+
+//--------------------
+// Function: GetPlanes
+//--------------------
+template<class Pinout>
+int Dmd<Pinout>::GetPlanes()
+{
+  return cntPlanes;
 }
 
-//--------
-//--------
-// PRIVATE
-//--------
-//--------
 //-------------------------
-// Function: UpdateRowType0
+// Function: GetGovernLevel
 //-------------------------
-int Dmd::UpdateRowType0()
+template<class Pinout>
+int Dmd<Pinout>::GetGovernLevel()
 {
-  int ret ;
-  int col;
-  byte *rowTop, *rowBottom ;
-  byte mask, maskR, maskG, maskB;
+  return levelGovern;
+}
 
-  rowTop = bufferInUse->dots[row];
-  rowBottom = bufferInUse->dots[row + 16];
+//---------------------------
+// Function: GetGovernChanges
+//---------------------------
+template<class Pinout>
+uint32_t Dmd<Pinout>::GetGovernChanges()
+{
+  return cntGovernChanges;
+}
 
-  mask = 0x01 << frame;
-  maskR = (colour + 1) & 0x01 ? 0xFF : 0x00;
-  maskG = (colour + 1) & 0x02 ? 0xFF : 0x00;
-  maskB = (colour + 1) & 0x04 ? 0xFF : 0x00;
-  
-  // Process each column, 2 at a time
-  for(col = 0; col < 128; )
+//--------------------
+// Function: Calibrate
+//--------------------
+template<class Pinout>
+bool Dmd<Pinout>::Calibrate(int hzRefresh)
+{
+  DmdStats get;
+  uint32_t cyclesRow = 0;
+  uint32_t microsStart = micros();
+  uint32_t cntStatsStart = cntStats.load();
+  bool ret;
+
+  // Check range
+  if(hzRefresh <= 0)
   {
-    byte  data1,
-          data2;
+    // Out of range, return
+    return false;
+  }
 
-    // Disable the display at the appropriate column, thereby setting the brightness
-    if(col ==  brightness)
+  // Wait for a profile begun since, one is published every second, the next may have begun before
+  while(cntStats.load() - cntStatsStart < 2)
+  {
+    if(micros() - microsStart >= 3000000)
     {
-      digitalWriteFast(pinEN, HIGH);
+      // Not refreshing
+      return false;
     }
 
-    // Extract the 2 data rows
-    data1 = *rowTop & mask;
-    data2 = *rowBottom & mask;
-    
-    // Clock LOW
-    digitalWriteFast(pinSK, LOW);
-
-    // Set data
-    // Red
-    digitalWriteFast(pinR1, data1 & maskR);
-    digitalWriteFast(pinR2, data2 & maskR);
-    // Green
-    digitalWriteFast(pinG1, data1 & maskG);
-    digitalWriteFast(pinG2, data2 & maskG);
-
-    #ifdef HUB75
-    // Blue
-    digitalWriteFast(pinB1, data1 & maskB);
-    digitalWriteFast(pinB2, data2 & maskB);
-    #else
-    // Stop compile warning
-    maskB = maskB;
-    #endif
-
-    // Clock HIGH
-    digitalWriteFast(pinSK, HIGH);
-
-    rowTop++;
-    rowBottom++;
-    col++;
-    
-    // Disable the display at the appropriate column, thereby setting the brightness
-    if(col ==  brightness)
-    {
-      digitalWriteFast(pinEN, HIGH);
-    }
+    yield();
+  }
 
-    // Extract the 2 data rows
-    data1 = *rowTop & mask;
-    data2 = *rowBottom & mask;
-    
-    // Clock LOW
-    digitalWriteFast(pinSK, LOW);
+  // No plane may be shorter than the longest row update took, or its row overruns into the next
+  GetStats(get);
+  for(int plane = 0; plane < get.cntPlanes; plane++)
+  {
+    cyclesRow = max(cyclesRow, get.planes[plane].cyclesMax);
+  }
+  microsPlaneFloor = max((uint32_t)1, (cyclesRow + (F_CPU / 1000000) - 1) / (F_CPU / 1000000));
 
-    // Set data
-    // Red
-    digitalWriteFast(pinR1, data1 & maskR);
-    digitalWriteFast(pinR2, data2 & maskR);
-    // Green
-    digitalWriteFast(pinG1, data1 & maskG);
-    digitalWriteFast(pinG2, data2 & maskG);
+  // Share the target refresh between the planes asked for
+  if(levelGovern > 0)
+  {
+    cntPlanes = cntPlanesTarget;
+    levelGovern = 0;
+    CompileLevelPlanes();
+  }
+  ret = DistributePlaneTimings(1000000 / hzRefresh / DmdScan);
 
-    #ifdef HUB75
-    // Blue
-    digitalWriteFast(pinB1, data1 & maskB);
-    digitalWriteFast(pinB2, data2 & maskB);
-    #endif
+  // New target for the governor
+  microsTotalTarget = 1000000 / hzRefresh / DmdScan;
 
-    // Clock HIGH
-    digitalWriteFast(pinSK, HIGH);
+  return ret;
+}
 
-    rowTop++;
-    rowBottom++;
-    col++;
+//-------------------
+// Function: SetGamma
+//-------------------
+template<class Pinout>
+bool Dmd<Pinout>::SetGamma(float set)
+{
+  // Check range
+  if(set < 1.0 || set > 3.0)
+  {
+    // Out of range, return
+    return false;
   }
 
+  // Applied as each frame is compiled, from the next one presented
+  gamma = set;
+  CompileLevelPlanes();
+
+  return true;
+}
+
+//--------
+//--------
+// PRIVATE
+//--------
+//--------
+//--------------------
+// Function: UpdateRow
+//--------------------
+template<class Pinout>
+int Dmd<Pinout>::UpdateRow()
+{
+  int ret ;
+  uint32_t cyclesStart;
+  DmdScanlines& scanlines = buffers[(byte)(idxHead.load() - 1) % DmdQueueSlots];
+
+  // Stream the port words of each clock pulse, other interrupts are free to preempt the shift
+  (this->*shiftRow)(planes[(scanlines.posPlanes + frame) % DmdQueuePlanes][row]);
+
+  // Latch, row address and enable go out as one
+  noInterrupts();
+  cyclesStart = ARM_DWT_CYCCNT;
+
+  // Disable display for the latch, should the on time not be up already
+  Enable::Disable();
+
   // Data latch LOW
-  digitalWriteFast(pinLT, HIGH);
+  DMD_PIN_WRITE(Pinout::pinLT, HIGH);
 
   // Set row address
-  digitalWriteFast(pinLA, row & 0b0001);
-  digitalWriteFast(pinLB, row & 0b0010);
-  digitalWriteFast(pinLC, row & 0b0100);
-  digitalWriteFast(pinLD, row & 0b1000);
+  DMD_PIN_WRITE(Pinout::pinLA, row & 0b0001);
+  DMD_PIN_WRITE(Pinout::pinLB, row & 0b0010);
+  DMD_PIN_WRITE(Pinout::pinLC, row & 0b0100);
+  DMD_PIN_WRITE(Pinout::pinLD, row & 0b1000);
 
   // Data latch HIGH
-  digitalWriteFast(pinLT, LOW);
+  DMD_PIN_WRITE(Pinout::pinLT, LOW);
 
-  // Enable display
-  digitalWriteFast(pinEN, LOW);
+  // Enable display, the enable driver disables it again once the plane's on time is up
+  Enable::Pulse(ticksEnable[frame]);
+
+  // Track the longest interrupts off window
+  cyclesStart = ARM_DWT_CYCCNT - cyclesStart;
+  interrupts();
+  if(cyclesStart > cyclesIrqOff)
+  {
+    cyclesIrqOff = cyclesStart;
+  }
+
+  // Start whatever darkens the display that is too slow to start with interrupts off
+  Enable::Arm();
 
-  // Return value is row pause to create the dot intensities
-  int rets[] = { 1, 2, 30, 45};
-  ret = rets[frame];
-  
   // Next row
   row++;
-  if(row & 0x10)
+  if(row == DmdScan)
   {
     // Finished a frame
     row = 0;
 
     // Next frame
     frame++;
-    if(frame & 0x04)
+    if(frame >= scanlines.cntPlanes)
     {
       // Finished a full frame
       frame = 0;
 
-      // Select the in-use buffer
-      bufferInUse = bufferActive;
+      // Time the refresh
+      uint32_t microsNow = micros();
+      microsRefreshPeriod = microsNow - microsRefreshStart;
+      microsRefreshStart = microsNow;
+
+      // Take the latest queued frame due by the middle of the next refresh, releasing those before it
+      byte idxSlot = idxHead.load();
+      while(idxSlot != idxTail.load() &&
+        (int32_t)(microsDue[idxSlot % DmdQueueSlots] - microsNow) <= (int32_t)(microsRefreshPeriod / 2))
+      {
+        idxSlot++;
+      }
+
+      if(idxSlot != idxHead.load())
+      {
+        // A new frame reaches the panel
+        idxHead.store(idxSlot);
+        cntPresented++;
+      }
+
+      // Display state changes take effect for the whole of the refresh
+      ApplyCommands();
+      CompileEnableTicks();
+
+      // Publish the timer probe
+      cyclesTimerRefresh = cyclesTimer;
+      cyclesTimer = 0;
+
+      // Publish the profile once a second
+      cntRefreshesStats++;
+      if(microsNow - microsStatsStart >= 1000000)
+      {
+        PublishStats(microsNow);
+      }
+
+      // Refresh cycle complete
+      cntRefreshes++;
+      if(callbackRefresh != NULL)
+      {
+        callbackRefresh(cntRefreshes.load());
+      }
     }
   }
 
+  // Return value is the row pause that follows the next row, to create the dot intensities
+  ret = buffers[(byte)(idxHead.load() - 1) % DmdQueueSlots].microsPlanes[frame];
+
   return ret;
 }
 
+//---------------------
+// Function: ProfileRow
+//---------------------
+template<class Pinout>
+void Dmd<Pinout>::ProfileRow(int plane, uint32_t cyclesIsr, uint32_t microsSlot)
+{
+  DmdPlaneStats& planeStats = stats.planes[plane];
+
+  if(planeStats.cntRows == 0 || cyclesIsr < planeStats.cyclesMin)
+  {
+    planeStats.cyclesMin = cyclesIsr;
+  }
+
+  if(cyclesIsr > planeStats.cyclesMax)
+  {
+    planeStats.cyclesMax = cyclesIsr;
+  }
+
+  planeStats.cyclesTotal += cyclesIsr;
+  planeStats.cntRows++;
+
+  // Overrun, the next row was due before this one finished
+  if(cyclesIsr > microsSlot * (F_CPU / 1000000))
+  {
+    planeStats.cntOverruns++;
+    stats.cntOverruns++;
+  }
+}
+
+//-----------------------
+// Function: PublishStats
+//-----------------------
+template<class Pinout>
+void Dmd<Pinout>::PublishStats(uint32_t microsNow)
+{
+  // Longest interrupts off window
+  cyclesIrqOffSecond = cyclesIrqOff;
+  cyclesIrqOff = 0;
+
+  // Isr profile
+  uint64_t cyclesTotal = 0;
+
+  stats.cntPlanes = buffers[(byte)(idxHead.load() - 1) % DmdQueueSlots].cntPlanes;
+  stats.hzRefresh = (uint64_t)cntRefreshesStats * 1000000 / (microsNow - microsStatsStart);
+  for(int plane = 0; plane < DmdPlanesMax; plane++)
+  {
+    cyclesTotal += stats.planes[plane].cyclesTotal;
+    if(stats.planes[plane].cntRows > 0)
+    {
+      stats.planes[plane].cyclesAvg = stats.planes[plane].cyclesTotal / stats.planes[plane].cntRows;
+    }
+  }
+
+  // Share of the cpu taken by the isr
+  stats.dutyIsr = cyclesTotal * 100 / ((uint64_t)(microsNow - microsStatsStart) * (F_CPU / 1000000));
+
+  statsSecond = stats;
+  cntStats++;
+
+  // Start the next second
+  memset(&stats, 0, sizeof(stats));
+  cntRefreshesStats = 0;
+  microsStatsStart = microsNow;
+}
+
+//-----------------
+// Function: Govern
+//-----------------
+template<class Pinout>
+void Dmd<Pinout>::Govern()
+{
+  DmdStats get;
+  int levelMax = (cntPlanesTarget - DmdPlanesMin) + stepsGovernStretch;
+  int level = levelGovern;
+
+  // Wait for a profile taken wholly since the last change
+  if((int32_t)(cntStats.load() - cntStatsGovern) < 0)
+  {
+    return;
+  }
+  cntStatsGovern = cntStats.load() + 1;
+
+  GetStats(get);
+  if(get.dutyIsr > dutyGovernHigh && level < levelMax)
+  {
+    // Isr starving the renderer, ease the refresh
+    level++;
+  }
+  else
+  if(get.dutyIsr < dutyGovernLow && level > 0)
+  {
+    // Load has dropped, restore the refresh
+    level--;
+  }
+
+  if(level != levelGovern)
+  {
+    levelGovern = level;
+    ApplyGovernLevel();
+    cntGovernChanges++;
+
+    // The profile in progress is mixed, decide on the one after
+    cntStatsGovern = cntStats.load() + 2;
+  }
+}
+
+//---------------------------
+// Function: ApplyGovernLevel
+//---------------------------
+template<class Pinout>
+void Dmd<Pinout>::ApplyGovernLevel()
+{
+  // First give up planes, fewer rows per refresh at the same refresh rate
+  int planes = max(DmdPlanesMin, cntPlanesTarget - levelGovern);
+
+  // Then lower the refresh rate, stretching the plane times
+  int stretch = levelGovern - (cntPlanesTarget - planes);
+
+  if(planes != cntPlanes)
+  {
+    cntPlanes = planes;
+    CompileLevelPlanes();
+  }
+  DistributePlaneTimings(microsTotalTarget * (stepsGovernStretch + stretch) / stepsGovernStretch);
+}
+
+//-------------------
+// Function: ShiftRow
+//-------------------
+template<class Pinout>
+template<int cntPorts>
+void Dmd<Pinout>::ShiftRow(const DmdLaneCode *codes)
+{
+  // Bank only changes between refreshes
+  int bank = bankWords.load(std::memory_order_relaxed);
+
+  for(int col = 0; col < DmdScanPulses; col++)
+  {
+    ShiftColumn<cntPorts>(codes[col], bank);
+  }
+}
+
+//----------------------
+// Function: ShiftColumn
+//----------------------
+template<class Pinout>
+template<int cntPorts>
+inline void Dmd<Pinout>::ShiftColumn(DmdLaneCode code, int bank)
+{
+  // A clear and set word per port, the clock's port first so the clock is LOW before any data changes, unrolled
+  // for the port and chain count
+  for(int port = 0; port < cntPorts; port++)
+  {
+    uint32_t word = 0;
+
+    for(int chain = 0; chain < DmdChains; chain++)
+    {
+      word |= layout.ports[port].words[bank][chain][(code >> (chain * DmdLanesChain)) & (DmdLaneCodes - 1)];
+    }
+
+    DMD_PORT_WRITE(layout.ports[port].regClear, layout.ports[port].maskClear);
+    DMD_PORT_WRITE(layout.ports[port].regSet, word);
+  }
+
+  // Clock HIGH
+  DMD_PORT_WRITE(layout.regClockSet, layout.maskClock);
+}
+
+//-----------------------
+// Function: QueueCommand
+//-----------------------
+template<class Pinout>
+bool Dmd<Pinout>::QueueCommand(byte type, int value)
+{
+  DmdCommand command = { type, value };
+  byte idxSlot = idxCommandTail.load();
+
+  // Nothing scanning, apply straight away
+  if(!isActive)
+  {
+    ApplyCommand(command);
+    return true;
+  }
+
+  // Queue full? The isr empties it at the start of the next refresh
+  while((byte)(idxSlot - idxCommandHead.load()) >= DmdCommandSlots)
+  {
+    yield();
+  }
+
+  // Hand the command over to the isr
+  commands[idxSlot % DmdCommandSlots] = command;
+  idxCommandTail.store(idxSlot + 1);
+
+  return true;
+}
+
 //-------------------------
-// Function: UpdateRowType1
+// Function: QueuePortWords
 //-------------------------
-int Dmd::UpdateRowType1()
+template<class Pinout>
+void Dmd<Pinout>::QueuePortWords()
 {
-  int ret ;
-  int col;
-  byte *rowTop, *rowBottom ;
-  byte mask, maskR, maskG, maskB;
+  byte bank;
 
-  rowTop = bufferInUse->dots[row];
-  rowBottom = bufferInUse->dots[row + 16];
+  // Wait for the isr to take up the bank last queued, the other is then free to compile into
+  while(isActive && bankWords.load() != bankWordsQueued)
+  {
+    yield();
+  }
 
-  mask = 0x01 << frame;
-  maskR = (colour + 1) & 0x01 ? 0xFF : 0x00;
-  maskG = (colour + 1) & 0x02 ? 0xFF : 0x00;
-  maskB = (colour + 1) & 0x04 ? 0xFF : 0x00;
-  
-  // Process each column, 2 at a time
-  // Code has been flattened out to improve performance
-  for(col = 0; col < 128; )
+  bank = (bankWordsQueued + 1) % DmdWordBanks;
+  CompilePortWords(bank);
+  bankWordsQueued = bank;
+
+  QueueCommand(DmdCommandWords, bank);
+}
+
+//------------------------
+// Function: ApplyCommands
+//------------------------
+template<class Pinout>
+void Dmd<Pinout>::ApplyCommands()
+{
+  byte idxSlot = idxCommandHead.load();
+
+  // Apply every change queued, in order
+  while(idxSlot != idxCommandTail.load())
+  {
+    ApplyCommand(commands[idxSlot % DmdCommandSlots]);
+    idxSlot++;
+  }
+
+  idxCommandHead.store(idxSlot);
+}
+
+//-----------------------
+// Function: ApplyCommand
+//-----------------------
+template<class Pinout>
+void Dmd<Pinout>::ApplyCommand(const DmdCommand& command)
+{
+  switch(command.type)
   {
-    byte  data1,
-          data2;
+    case DmdCommandBrightness:
+      // Fraction of each plane's time the display is enabled for
+      dutyEnable = (command.value + 1) / 64.0;
+      break;
+
+    case DmdCommandWords:
+      // Port words for a new colour or screen type
+      bankWords.store(command.value);
+      break;
+  }
+}
 
-    // Disable the display at the appropriate column, thereby setting the brightness
-    if(col ==  brightness)
+//----------------------------
+// Function: CompilePortLayout
+//----------------------------
+template<class Pinout>
+void Dmd<Pinout>::CompilePortLayout()
+{
+  const int pinLanes[12] = { Pinout::pinR1, Pinout::pinG1, Pinout::pinB1, Pinout::pinR2, Pinout::pinG2, Pinout::pinB2,
+                             Pinout::pinR3, Pinout::pinG3, Pinout::pinB3, Pinout::pinR4, Pinout::pinG4, Pinout::pinB4 };
+  volatile uint32_t *regSet, *regClear;
+  uint32_t mask;
+  int port;
+
+  memset(&layout, 0, sizeof(layout));
+
+  // Clock's port is written first, its clear store takes the clock LOW ahead of every data store of the column
+  pinPort(Pinout::pinSK, regSet, regClear, mask);
+  layout.ports[0].regSet = regSet;
+  layout.ports[0].regClear = regClear;
+  layout.ports[0].maskClear = mask;
+  layout.regClockSet = regSet;
+  layout.maskClock = mask;
+  layout.cntPorts = 1;
+
+  // Each data line of each chain joins the port it is wired to
+  for(int lane = 0; lane < DmdLanesChain * DmdChains; lane++)
+  {
+    if(!Pinout::hasBlue && (lane % 3) == 2)
     {
-      digitalWriteFast(pinEN, HIGH);
+      // No blue lines on this screen
+      continue;
     }
 
-    // Extract the 2 data rows
-    data1 = *rowTop & mask;
-    data2 = *rowBottom & mask;
-
-    data1 = !data1;
-    data2 = !data2;
-    
-    // Clock LOW
-    digitalWriteFast(pinSK, LOW);
-
-    // Set data
-    // Red
-    digitalWriteFast(pinR1, data1 & maskR);
-    digitalWriteFast(pinR2, data2 & maskR);
-    // Green
-    digitalWriteFast(pinG1, data1 & maskG);
-    digitalWriteFast(pinG2, data2 & maskG);
-
-    #ifdef HUB75
-    // Blue
-    digitalWriteFast(pinB1, data1 & maskB);
-    digitalWriteFast(pinB2, data2 & maskB);
-    #else
-    // Stop compile warning
-    maskB = maskB;
-    #endif
-
-    // Clock HIGH
-    digitalWriteFast(pinSK, HIGH);
-
-    rowTop++;
-    rowBottom++;
-    col++;
-
-    // Disable the display at the appropriate column, thereby setting the brightness
-    if(col ==  brightness)
+    pinPort(pinLanes[lane], regSet, regClear, mask);
+
+    for(port = 0; port < layout.cntPorts && layout.ports[port].regSet != regSet; port++);
+    if(port == layout.cntPorts)
     {
-      digitalWriteFast(pinEN, HIGH);
+      // First line on this port
+      layout.ports[port].regSet = regSet;
+      layout.ports[port].regClear = regClear;
+      layout.cntPorts++;
     }
 
-    // Extract the 2 data rows
-    data1 = *rowTop & mask;
-    data2 = *rowBottom & mask;
+    layout.ports[port].maskClear |= mask;
+    layout.ports[port].maskLane[lane] = mask;
+  }
+
+}
 
-    data1 = !data1;
-    data2 = !data2;
-    
-    // Clock LOW
-    digitalWriteFast(pinSK, LOW);
+//---------------------------
+// Function: CompilePortWords
+//---------------------------
+template<class Pinout>
+void Dmd<Pinout>::CompilePortWords(int bank)
+{
+  byte lanesColour, lanesInvert;
 
-    // Set data
-    // Red
-    digitalWriteFast(pinR1, data1 & maskR);
-    digitalWriteFast(pinR2, data2 & maskR);
-    // Green
-    digitalWriteFast(pinG1, data1 & maskG);
-    digitalWriteFast(pinG2, data2 & maskG);
+  // Colour selects the lanes driven for a lit dot, a colour frame drives them itself
+  lanesColour = (DmdChannels == 1 ? (colour + 1) & 0x07 : 0x07);
+  lanesColour |= lanesColour << 3;
 
-    #ifdef HUB75
-    // Blue
-    digitalWriteFast(pinB1, data1 & maskB);
-    digitalWriteFast(pinB2, data2 & maskB);
-    #endif
+  // Type 1 screens light a dot on a LOW data line
+  lanesInvert = (dmdType == 1 ? 0x3F : 0x00);
 
-    // Clock HIGH
-    digitalWriteFast(pinSK, HIGH);
+  for(int port = 0; port < layout.cntPorts; port++)
+  {
+    DmdPort& dmdPort = layout.ports[port];
 
-    rowTop++;
-    rowBottom++;
-    col++;
+    // Each chain has a table of its own, the scanout combines them
+    for(int chain = 0; chain < DmdChains; chain++)
+    {
+      for(int code = 0; code < DmdLaneCodes; code++)
+      {
+        byte lanes = (code ^ lanesInvert) & lanesColour;
+        uint32_t word = 0;
+
+        for(int lane = 0; lane < DmdLanesChain; lane++)
+        {
+          if(lanes & (1 << lane))
+          {
+            word |= dmdPort.maskLane[(chain * DmdLanesChain) + lane];
+          }
+        }
+
+        dmdPort.words[bank][chain][code] = word;
+      }
+    }
   }
+}
 
-  // Data latch LOW
-  digitalWriteFast(pinLT, HIGH);
+//-------------------------
+// Function: CompileScanMap
+//-------------------------
+template<class Pinout>
+void Dmd<Pinout>::CompileScanMap()
+{
+  const int cntBlocks = DmdChainWidth / DmdScanOrder::block;
 
-  // Set row address
-  digitalWriteFast(pinLA, row & 0b0001);
-  digitalWriteFast(pinLB, row & 0b0010);
-  digitalWriteFast(pinLC, row & 0b0100);
-  digitalWriteFast(pinLD, row & 0b1000);
+  // Straight through, nothing to map
+  if(!DmdScanMapped)
+  {
+    return;
+  }
 
-  // Data latch HIGH
-  digitalWriteFast(pinLT, LOW);
+  // A row address drives every DmdScan'th row of a half, their dots go out a block of each row in turn
+  for(int address = 0; address < DmdScan; address++)
+  {
+    for(int pulse = 0; pulse < DmdScanPulses; pulse++)
+    {
+      int turn = pulse / DmdScanOrder::block;
+      int block = turn / DmdScanRows;
+      int row = turn % DmdScanRows;
+
+      if(DmdScanOrder::rowOrder == DmdRowsBottomFirst || (DmdScanOrder::rowOrder == DmdRowsAlternate && (block & 0x01)))
+      {
+        row = DmdScanRows - 1 - row;
+      }
+
+      if(DmdScanOrder::blockOrder == DmdBlocksRightFirst)
+      {
+        block = cntBlocks - 1 - block;
+      }
+
+      scanMap[address][pulse].x = (block * DmdScanOrder::block) + (pulse % DmdScanOrder::block);
+      scanMap[address][pulse].y = address + (row * DmdScan);
+    }
+  }
+}
 
-  // Enable display
-  digitalWriteFast(pinEN, LOW);
+//---------------------------
+// Function: CompileScanlines
+//---------------------------
+template<class Pinout>
+void Dmd<Pinout>::CompileScanlines(DmdFrame& source, DmdScanlines *scanlines)
+{
+  // Modulation gives a mono frame a level per channel
+  int cntChannels = (isModulated ? 3 : DmdChannels);
+  DmdScanPlane *planesSlot[DmdPlanesMax];
 
-  // Return value is row pause to create the dot intensities
-  int rets[] = { 1, 2, 30, 45};
-  ret = rets[frame];
+  // Planes and timings go with the frame so they change over at the same time
+  scanlines->cntPlanes = cntPlanes;
+  memcpy(scanlines->microsPlanes, microsPlanes, sizeof(microsPlanes));
+  memcpy(scanlines->microsOn, microsOn, sizeof(microsOn));
 
-  // Next row
-  row++;
-  if(row & 0x10)
+  // A frame's planes may run on round the end of the pool
+  for(int plane = 0; plane < cntPlanes; plane++)
   {
-    // Finished a frame
-    row = 0;
+    planesSlot[plane] = &planes[(scanlines->posPlanes + plane) % DmdQueuePlanes];
+  }
 
-    // Next frame
-    frame++;
-    if(frame & 0x04)
+  // Each clock pulse carries a dot from the top and bottom half of every chain, in the order of the scan map
+  for(int y = 0; y < DmdScan; y++)
+  {
+    for(int chain = 0; chain < DmdChains; chain++)
     {
-      // Finished a full frame
-      frame = 0;
+      int xChain = DmdChainsStacked ? 0 : chain * DmdChainWidth;
+      int yChain = DmdChainsStacked ? chain * DmdChainHeight : 0;
+
+      for(int col = 0; col < DmdScanPulses; col++)
+      {
+        int x = xChain + (DmdScanMapped ? scanMap[y][col].x : col);
+        int yTop = yChain + (DmdScanMapped ? scanMap[y][col].y : y);
+        int yBottom = yTop + (DmdChainHeight / 2);
+        DmdLaneCode codes[DmdPlanesMax];
+
+        memset(codes, 0, sizeof(codes));
+
+        // A mono dot drives all lanes of its half and colour is applied by the port words,
+        // a colour frame or a modulated one has a channel per lane
+        for(int channel = 0; channel < cntChannels; channel++)
+        {
+          int channelSource = (DmdChannels == 1 ? 0 : channel);
+          DmdLaneCode lanesTop = (cntChannels == 1 ? DmdLaneR1 | DmdLaneG1 | DmdLaneB1 : DmdLaneR1 << channel);
+          DmdLaneCode lanesBottom = (cntChannels == 1 ? DmdLaneR2 | DmdLaneG2 | DmdLaneB2 : DmdLaneR2 << channel);
+          byte levelTop = (source.frame[channelSource].dots[yTop][x >> 1] >> ((x & 0x01) * 4)) & 0x0F;
+          byte levelBottom = (source.frame[channelSource].dots[yBottom][x >> 1] >> ((x & 0x01) * 4)) & 0x0F;
+
+          if(isModulated)
+          {
+            levelTop = gainLevel(levelTop, gainRows[yTop], gainCols[x], channel);
+            levelBottom = gainLevel(levelBottom, gainRows[yBottom], gainCols[x], channel);
+          }
+
+          byte top = levelPlanes[levelTop];
+          byte bottom = levelPlanes[levelBottom];
+
+          for(int plane = 0; plane < cntPlanes; plane++)
+          {
+            codes[plane] |= ((top >> plane) & 0x01 ? lanesTop : 0x00) | ((bottom >> plane) & 0x01 ? lanesBottom : 0x00);
+          }
+        }
+
+        // Chains after the first are shifted out on their own lanes in the same pulse
+        for(int plane = 0; plane < cntPlanes; plane++)
+        {
+          if(chain == 0)
+          {
+            (*planesSlot[plane])[y][col] = codes[plane];
+          }
+          else
+          {
+            (*planesSlot[plane])[y][col] |= codes[plane] << (chain * DmdLanesChain);
+          }
+        }
+      }
+    }
+  }
+}
 
-      // Select the in-use buffer
-      bufferInUse = bufferActive;
+//---------------------------------
+// Function: DistributePlaneTimings
+//---------------------------------
+template<class Pinout>
+bool Dmd<Pinout>::DistributePlaneTimings(int32_t microsTotal)
+{
+  int32_t weightTotal = (1 << cntPlanes) - 1;
+  int32_t microsFloor = microsPlaneFloor;
+  float microsUnit = 0;
+  int cntFloored;
+  bool ret = true;
+
+  // Each plane is lit for twice as long as the one before, and shown for the whole microseconds that covers
+  // but no less than the floor, the shortest planes may be held at the floor and lit for just their share of it
+  for(cntFloored = 0; cntFloored < cntPlanes; cntFloored++)
+  {
+    microsUnit = (float)(microsTotal - (cntFloored * microsFloor)) / (weightTotal + 1 - (1 << cntFloored));
+    if(microsUnit * (1 << cntFloored) >= microsFloor)
+    {
+      break;
     }
   }
 
+  // Too short even then, every plane at the floor
+  if(cntFloored == cntPlanes)
+  {
+    microsUnit = (float)microsFloor / (1 << (cntPlanes - 1));
+    ret = false;
+  }
+
+  memset(microsPlanes, 0, sizeof(microsPlanes));
+  memset(microsOn, 0, sizeof(microsOn));
+  for(int plane = 0; plane < cntPlanes; plane++)
+  {
+    microsOn[plane] = microsUnit * (1 << plane);
+    microsPlanes[plane] = (plane < cntFloored ? microsFloor : (int32_t)ceilf(microsOn[plane]));
+  }
+
   return ret;
 }
 
-//------------------
-// Function: isrDmd0
-//------------------
-static void isrDmdType0()
+//-----------------------------
+// Function: CompileLevelPlanes
+//-----------------------------
+template<class Pinout>
+void Dmd<Pinout>::CompileLevelPlanes()
 {
-  // Call the class instance isr routine
-  noInterrupts();
-  dmd.IsrDmdType0();
-  interrupts();
+  int valueMax = (1 << cntPlanes) - 1;
+
+  // Dot levels are spread over the full range of the planes along the gamma curve
+  levelPlanes[0] = 0;
+  for(int level = 1; level < 16; level++)
+  {
+    int value = (int)((powf(level / 15.0f, gamma) * valueMax) + 0.5f);
+
+    // Keep every level distinct from the one below while the planes allow it
+    if(value <= levelPlanes[level - 1])
+    {
+      value = min(levelPlanes[level - 1] + 1, valueMax);
+    }
+
+    levelPlanes[level] = value;
+  }
+}
+
+//-----------------------------
+// Function: CompileEnableTicks
+//-----------------------------
+template<class Pinout>
+void Dmd<Pinout>::CompileEnableTicks()
+{
+  DmdScanlines& scanlines = buffers[(byte)(idxHead.load() - 1) % DmdQueueSlots];
+  float ticksMicro = Enable::HzTicks() / 1000000.0f;
+
+  // Brightness share of each plane's time of the frame on screen in the enable driver's ticks, the isr only
+  // hands them over, and no plane is left dark however short
+  for(int plane = 0; plane < scanlines.cntPlanes; plane++)
+  {
+    uint32_t ticks = (uint32_t)((scanlines.microsOn[plane] * dutyEnable * ticksMicro) + 0.5f);
+
+    if(ticks < Enable::ticksMin)
+    {
+      ticks = Enable::ticksMin;
+    }
+    else if(ticks > Enable::ticksMax)
+    {
+      ticks = Enable::ticksMax;
+    }
+
+    ticksEnable[plane] = ticks;
+  }
 }
 
 //------------------
-// Function: isrDmd1
+// Function: pinPort
 //------------------
-static void isrDmdType1()
+static void pinPort(int pin, volatile uint32_t *&regSet, volatile uint32_t *&regClear, uint32_t& mask)
 {
-  // Call the class instance isr routine
-  noInterrupts();
-  dmd.IsrDmdType1();
-  interrupts();
+#if defined(KINETISK)
+  // Teensy 3.x hands out bit-band aliases of GPIOx_PDOR, map back to the port and bit
+  uint32_t offset = (uint32_t)portOutputRegister(pin) - 0x42000000;
+  uint32_t addrPdor = 0x40000000 + ((offset >> 5) & ~0x03);
+
+  regSet = (volatile uint32_t *)(addrPdor + 0x04);    // GPIOx_PSOR
+  regClear = (volatile uint32_t *)(addrPdor + 0x08);  // GPIOx_PCOR
+  mask = 1 << ((((offset >> 5) & 0x03) * 8) + ((offset >> 2) & 0x07));
+#else
+  // Teensy 4.x has whole-port set and clear registers
+  regSet = portSetRegister(pin);
+  regClear = portClearRegister(pin);
+  mask = digitalPinToBitMask(pin);
+#endif
+}
+
+//--------------------
+// Function: gainLevel
+//--------------------
+static inline byte gainLevel(byte level, uint16_t gainRow, uint16_t gainCol, int channel)
+{
+  int shift = 8 - (channel * 4);
+  int gain = ((gainRow >> shift) & 0x0F) * ((gainCol >> shift) & 0x0F);
+
+  // Both gains are out of 15, round to the nearest level
+  return ((level * gain) + 112) / 225;
+}
+
+//-----------------
+// Function: isrDmd
+//-----------------
+static void isrDmd()
+{
+  // Call the class instance isr routine, it holds interrupts off only for the latch
+  dmd.IsrDmd();
 }
 
+// Driver for the configured screen type
+template class Dmd<DmdPinout>;
+
 // End of file
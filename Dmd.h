@@ -1,46 +1,161 @@
 #ifndef __DMD_H__
 #define __DMD_H__
 
+#include <atomic>
+
 #include "DmdFrame.h"
 #include "DmdFrameRaw.h"
+#include "DmdEnable.h"
+#include "DmdScanlines.h"
+#include "Pinout.h"
+
+// Refresh isr profile of a plane, durations in cycles
+typedef struct tagDmdPlaneStats
+{
+  uint32_t cyclesMin;
+  uint32_t cyclesAvg;
+  uint32_t cyclesMax;
+  uint32_t cyclesTotal;
+  uint32_t cntRows;
+  uint32_t cntOverruns;
+} DmdPlaneStats;
+
+// Refresh isr profile over a second
+typedef struct tagDmdStats
+{
+  int cntPlanes;
+  uint32_t hzRefresh;
+  uint32_t dutyIsr;
+  uint32_t cntOverruns;
+  DmdPlaneStats planes[DmdPlanesMax];
+} DmdStats;
+
+// Display state change, queued by the renderer and applied by the isr at the start of a refresh
+typedef struct tagDmdCommand
+{
+  byte type;
+  int value;
+} DmdCommand;
 
+enum {
+  DmdCommandBrightness = 0,
+  DmdCommandWords,
+};
+
+// Called from the isr at the end of each refresh cycle
+typedef void (*DMDREFRESHCALLBACK)(uint32_t cntRefreshes);
+
+template<class Pinout>
 class Dmd
 {
   private:
-    DmdFrameRaw buffer1;
-    DmdFrameRaw buffer2;
-    DmdFrameRaw *bufferActive;
-    DmdFrameRaw *bufferInactive;
-    DmdFrameRaw *bufferInUse;
+    // Frame queue, filled at tail, the slot before head is on screen
+    DmdScanlines buffers[DmdQueueSlots];
+    DmdScanPlane planes[DmdQueuePlanes];
+    uint32_t microsDue[DmdQueueSlots];
+    std::atomic<byte> idxHead;
+    std::atomic<byte> idxTail;
+    uint32_t microsLastDue;
+    uint32_t microsRefreshStart;
+    uint32_t microsRefreshPeriod;
+
+    // Timer reload cycles
+    uint32_t cyclesTimer;
+    uint32_t cyclesTimerRefresh;
+
+    // Longest interrupts off window, running and last second
+    uint32_t cyclesIrqOff;
+    uint32_t cyclesIrqOffSecond;
+
+    // Isr profile, running and last second
+    DmdStats stats;
+    DmdStats statsSecond;
+    uint32_t microsStatsStart;
+    uint32_t cntRefreshesStats;
+    std::atomic<uint32_t> cntStats;
+
+    // Load governor
+    int cntPlanesTarget;
+    int32_t microsTotalTarget;
+    int levelGovern;
+    uint32_t cntStatsGovern;
+    uint32_t cntGovernChanges;
+
+    // Vsync counters
+    std::atomic<uint32_t> cntPresented;
+    std::atomic<uint32_t> cntRefreshes;
+    DMDREFRESHCALLBACK callbackRefresh;
+
+    // Display state changes, applied by the isr
+    DmdCommand commands[DmdCommandSlots];
+    std::atomic<byte> idxCommandHead;
+    std::atomic<byte> idxCommandTail;
+    bool isActive;
+
+    // Port word banks, in use and last queued
+    std::atomic<byte> bankWords;
+    byte bankWordsQueued;
+
+    // Back buffer
+    DmdFrame frameBack;
+
+    // Row and column gains, 0x0RGB
+    uint16_t gainRows[DmdHeight];
+    uint16_t gainCols[DmdWidth];
+    bool isModulated;
+
+    DmdPortLayout layout;
+
+    // Dot of each clock pulse, unused when unmapped
+    DmdScanDot scanMap[DmdScanMapped ? DmdScan : 1][DmdScanMapped ? DmdScanPulses : 1];
+
+    // Bit-planes and their timings
+    int cntPlanes;
+    uint16_t microsPlanes[DmdPlanesMax];
+    float microsOn[DmdPlanesMax];
+    uint16_t microsPlaneFloor;
+    byte levelPlanes[16];
+    float gamma;
     
     IntervalTimer timerDmd ;
 
+    // Output enable driver and plane on times
+    typedef DmdEnable<Pinout::pinEN> Enable;
+    uint32_t ticksEnable[DmdPlanesMax];
+
     int frame ;
     int row ;
     int brightness ;
+    float dutyEnable ;
     byte colour;
     int dmdType ;
-    
-    int pinEN;
-    int pinR1;
-    int pinR2;
-    int pinG1;
-    int pinG2;
-    int pinB1;
-    int pinB2;
-    int pinLA;
-    int pinLB;
-    int pinLC;
-    int pinLD;
-    int pinLT;
-    int pinSK;
   
-    int UpdateRowType0();
-    int UpdateRowType1();
+    // Row shift kernel
+    void (Dmd::*shiftRow)(const DmdLaneCode *codes);
+
+    int UpdateRow();
+    void ProfileRow(int plane, uint32_t cyclesIsr, uint32_t microsSlot);
+    void PublishStats(uint32_t microsNow);
+    void Govern();
+    void ApplyGovernLevel();
+    template<int cntPorts> void ShiftRow(const DmdLaneCode *codes);
+    template<int cntPorts> void ShiftColumn(DmdLaneCode code, int bank);
+    bool QueueCommand(byte type, int value);
+    void QueuePortWords();
+    void ApplyCommands();
+    void ApplyCommand(const DmdCommand& command);
+    void CompilePortLayout();
+    void CompilePortWords(int bank);
+    void CompileScanMap();
+    bool QueueFrame(DmdFrame& source, uint32_t microsDue);
+    void CompileScanlines(DmdFrame& source, DmdScanlines *scanlines);
+    bool DistributePlaneTimings(int32_t microsTotal);
+    void CompileLevelPlanes();
+    void CompileEnableTicks();
 
   public:
     Dmd();
-    void Initialise(int pinEN, int pinR1, int pinR2, int pinG1, int pinG2, int pinB1, int pinB2, int pinLA, int pinLB, int pinLC, int pinLD, int pinLT, int pinSK);
+    void Initialise();
     void Start();
     void Stop();
     bool IsActive();
@@ -48,13 +163,30 @@ class Dmd
     int GetBrightness();
     bool SetColour(byte colour);
     byte GetColour();
-    void SetFrame(DmdFrame& frame);
+    DmdFrame& AcquireBackBuffer();
+    bool Present();
+    bool PresentAt(uint32_t microsDue);
+    bool Recompile();
+    bool SetRowGain(int y, uint16_t rgb);
+    bool SetColumnGain(int x, uint16_t rgb);
+    void ClearGains();
     bool WaitSync(uint32_t timeout = 0);  
-    void IsrDmdType0();
-    void IsrDmdType1();
+    bool WaitRefresh(uint32_t timeout = 0);
+    uint32_t GetPresentedCount();
+    uint32_t GetRefreshCount();
+    uint32_t GetTimerCycles();
+    uint32_t GetIrqOffCycles();
+    void GetStats(DmdStats& get);
+    void SetRefreshCallback(DMDREFRESHCALLBACK callback);
+    void IsrDmd();
     void SetDmdType(int dmdType);
+    bool SetPlanes(int cntPlanes);
+    int GetPlanes();
+    bool Calibrate(int hzRefresh);
+    bool SetGamma(float gamma);
+    int GetGovernLevel();
+    uint32_t GetGovernChanges();
     
 };
 
 #endif
-
@@ -0,0 +1,276 @@
+#ifndef __DMDENABLE_H__
+#define __DMDENABLE_H__
+
+#include <IntervalTimer.h>
+#include <Arduino.h>
+
+#include "Pinout.h"
+
+// Output enable driver, lights the display for an on time after each row latch and darkens it again by itself
+// EN is active LOW, the display is lit while it is LOW
+// On times are in ticks of the driver's own clock, at least ticksMin and at most ticksMax
+//   Begin   - take the pin over, display dark
+//   End     - hand the pin back as a GPIO, display dark
+//   Pulse   - light the display now for the ticks given
+//   Arm     - start whatever darkens it again that cannot be started with interrupts off
+//   Disable - darken the display now, should the on time not be up yet
+
+// Any pin, a one shot interval timer darkens the display, cycle counter ticks
+// On times too short for the timer to take, under 0.75us on Teensy 3.x and 4.x, are timed out on the cycle
+// counter instead
+// Starting and stopping the timer is slow, so it is started once interrupts are back on and left to stop itself,
+// a firing left over from the row before finds its on time not up and leaves the display lit
+template<int pin>
+class DmdEnable
+{
+  private:
+    static IntervalTimer timer;
+    static volatile uint32_t cyclesLit;
+    static volatile uint32_t ticksLit;
+
+    static void Isr()
+    {
+      // Within half the spin of the on time, the timer's own rounding
+      if(ARM_DWT_CYCCNT - cyclesLit + (ticksSpin / 2) >= ticksLit)
+      {
+        // One shot
+        timer.end();
+        DMD_PIN_WRITE(pin, HIGH);
+      }
+    }
+
+  public:
+    static const uint32_t ticksMin = 1;
+    static const uint32_t ticksMax = 0xFFFFFFFF;
+    static const uint32_t ticksSpin = (F_CPU / 1000000) * 3 / 4;
+
+    static uint32_t HzTicks()
+    {
+      return F_CPU;
+    }
+
+    static void Begin()
+    {
+      // Darkening must not wait behind a row update
+      timer.priority(190);
+      DMD_PIN_WRITE(pin, HIGH);
+    }
+
+    static void End()
+    {
+      timer.end();
+      Disable();
+    }
+
+    static void Pulse(uint32_t ticks)
+    {
+      cyclesLit = ARM_DWT_CYCCNT;
+      ticksLit = ticks;
+      DMD_PIN_WRITE(pin, LOW);
+      if(ticks < ticksSpin)
+      {
+        while(ARM_DWT_CYCCNT - cyclesLit < ticks);
+        DMD_PIN_WRITE(pin, HIGH);
+      }
+    }
+
+    static void Arm()
+    {
+      uint32_t cycles = ARM_DWT_CYCCNT - cyclesLit;
+
+      if(ticksLit < ticksSpin)
+      {
+        // Already dark
+      }
+      else if(cycles + ticksSpin >= ticksLit)
+      {
+        // Held up on the way here, too little of the on time left for the timer
+        while(ARM_DWT_CYCCNT - cyclesLit < ticksLit);
+        DMD_PIN_WRITE(pin, HIGH);
+      }
+      else
+      {
+        // Restarting the timer drops the firing of the row before, the rest of the on time from now
+        timer.begin(Isr, (float)(ticksLit - cycles) / (F_CPU / 1000000));
+      }
+    }
+
+    static void Disable()
+    {
+      DMD_PIN_WRITE(pin, HIGH);
+    }
+};
+
+template<int pin> IntervalTimer DmdEnable<pin>::timer;
+template<int pin> volatile uint32_t DmdEnable<pin>::cyclesLit;
+template<int pin> volatile uint32_t DmdEnable<pin>::ticksLit;
+
+#if defined(__IMXRT1062__)
+// Teensy 4.x pin 19 (HUB08) is QuadTimer3 channel 0, the count stops at the compare, which sets the output
+template<>
+class DmdEnable<19>
+{
+  public:
+    static const uint32_t ticksMin = 1;
+    static const uint32_t ticksMax = 0xFFFF;
+
+    static uint32_t HzTicks()
+    {
+      // IPG bus clock over 4
+      return F_BUS_ACTUAL / 4;
+    }
+
+    static void Begin()
+    {
+      Disable();
+      IOMUXC_SW_MUX_CTL_PAD_GPIO_AD_B1_00 = 1;
+    }
+
+    static void End()
+    {
+      Disable();
+      digitalWriteFast(19, HIGH);
+      pinMode(19, OUTPUT);
+    }
+
+    static void Pulse(uint32_t ticks)
+    {
+      // Output LOW now, counting up from 0 the compare sets it at ticks and the one shot stops there
+      IMXRT_TMR3.CH[0].CTRL = 0;
+      IMXRT_TMR3.CH[0].CNTR = 0;
+      IMXRT_TMR3.CH[0].COMP1 = ticks;
+      IMXRT_TMR3.CH[0].SCTRL = TMR_SCTRL_OEN;
+      IMXRT_TMR3.CH[0].SCTRL = TMR_SCTRL_OEN | TMR_SCTRL_FORCE;
+      IMXRT_TMR3.CH[0].CTRL = TMR_CTRL_CM(1) | TMR_CTRL_PCS(8 + 2) | TMR_CTRL_ONCE | TMR_CTRL_LENGTH | TMR_CTRL_OUTMODE(2);
+    }
+
+    static void Arm()
+    {
+    }
+
+    static void Disable()
+    {
+      // Stop the count and force the output HIGH
+      IMXRT_TMR3.CH[0].CTRL = 0;
+      IMXRT_TMR3.CH[0].SCTRL = TMR_SCTRL_OEN | TMR_SCTRL_VAL;
+      IMXRT_TMR3.CH[0].SCTRL = TMR_SCTRL_OEN | TMR_SCTRL_VAL | TMR_SCTRL_FORCE;
+    }
+};
+
+// Teensy 4.x pin 23 (HUB75) is FlexPWM4 submodule 1 A, asserted LOW from the start of the count to VAL3
+// The submodule has no one shot, restarting the count lights the display and the GPIO holds it dark between
+// pulses, so a row may be no longer than the count's range, 3.5ms
+template<>
+class DmdEnable<23>
+{
+  public:
+    static const uint32_t ticksMin = 1;
+    static const uint32_t ticksMax = 0x7FFF;
+
+    static uint32_t HzTicks()
+    {
+      // IPG bus clock over 16
+      return F_BUS_ACTUAL / 16;
+    }
+
+    static void Begin()
+    {
+      // GPIO HIGH until the first pulse
+      End();
+
+      IMXRT_FLEXPWM4.MCTRL |= FLEXPWM_MCTRL_CLDOK(0x02);
+      IMXRT_FLEXPWM4.SM[1].CTRL2 = FLEXPWM_SMCTRL2_INDEP | FLEXPWM_SMCTRL2_FRCEN | FLEXPWM_SMCTRL2_WAITEN | FLEXPWM_SMCTRL2_DBGEN;
+      IMXRT_FLEXPWM4.SM[1].CTRL = FLEXPWM_SMCTRL_FULL | FLEXPWM_SMCTRL_LDMOD | FLEXPWM_SMCTRL_PRSC(4);
+      IMXRT_FLEXPWM4.SM[1].INIT = 0;
+      IMXRT_FLEXPWM4.SM[1].VAL0 = 0;
+      IMXRT_FLEXPWM4.SM[1].VAL1 = ticksMax;
+      IMXRT_FLEXPWM4.SM[1].VAL2 = 0;
+      IMXRT_FLEXPWM4.SM[1].VAL3 = 0;
+      IMXRT_FLEXPWM4.SM[1].OCTRL = FLEXPWM_SMOCTRL_POLA;
+      IMXRT_FLEXPWM4.OUTEN |= FLEXPWM_OUTEN_PWMA_EN(0x02);
+      IMXRT_FLEXPWM4.MCTRL |= FLEXPWM_MCTRL_LDOK(0x02) | FLEXPWM_MCTRL_RUN(0x02);
+    }
+
+    static void End()
+    {
+      digitalWriteFast(23, HIGH);
+      pinMode(23, OUTPUT);
+    }
+
+    static void Pulse(uint32_t ticks)
+    {
+      // New deassert compare taken at once, then restart the count and hand the pin to the submodule
+      IMXRT_FLEXPWM4.SM[1].VAL3 = ticks;
+      IMXRT_FLEXPWM4.MCTRL |= FLEXPWM_MCTRL_LDOK(0x02);
+      IMXRT_FLEXPWM4.SM[1].CTRL2 |= FLEXPWM_SMCTRL2_FORCE;
+      IOMUXC_SW_MUX_CTL_PAD_GPIO_AD_B1_09 = 1;
+    }
+
+    static void Arm()
+    {
+    }
+
+    static void Disable()
+    {
+      // Back to the GPIO, which is HIGH
+      IOMUXC_SW_MUX_CTL_PAD_GPIO_AD_B1_09 = 5 | 0x10;
+    }
+};
+#elif defined(KINETISK)
+// Teensy 3.x pin 23 (HUB75) is FTM0 channel 1, the counter free runs and a compare match sets the output
+// The output is forced LOW through its initial value and the compare is set the on time ahead of the count,
+// which has to still be ahead once written
+template<>
+class DmdEnable<23>
+{
+  private:
+    static const uint32_t outinitCh1 = 0x02;
+
+  public:
+    static const uint32_t ticksMin = 4;
+    static const uint32_t ticksMax = 0xFFFF - 1;
+
+    static uint32_t HzTicks()
+    {
+      // Bus clock over 4
+      return F_BUS / 4;
+    }
+
+    static void Begin()
+    {
+      FTM0_SC = 0;
+      FTM0_CNT = 0;
+      FTM0_MOD = 0xFFFF;
+      FTM0_C1SC = FTM_CSC_MSA | FTM_CSC_ELSB | FTM_CSC_ELSA;
+      Disable();
+      FTM0_SC = FTM_SC_CLKS(1) | FTM_SC_PS(2);
+      CORE_PIN23_CONFIG = PORT_PCR_MUX(4) | PORT_PCR_DSE | PORT_PCR_SRE;
+    }
+
+    static void End()
+    {
+      Disable();
+      digitalWriteFast(23, HIGH);
+      pinMode(23, OUTPUT);
+    }
+
+    static void Pulse(uint32_t ticks)
+    {
+      FTM0_OUTINIT = 0;
+      FTM0_MODE |= FTM_MODE_INIT;
+      FTM0_C1V = (uint16_t)(FTM0_CNT + ticks);
+    }
+
+    static void Arm()
+    {
+    }
+
+    static void Disable()
+    {
+      FTM0_OUTINIT = outinitCh1;
+      FTM0_MODE |= FTM_MODE_INIT;
+    }
+};
+#endif
+
+#endif
@@ -1,62 +1,405 @@
 #include <Arduino.h>
 
 #include "DmdFrame.h"
+#include "DmdNibbles.h"
 
-DmdFrame::DmdFrame()
+//-------------------
+// Function: getLevel
+//-------------------
+static inline byte getLevel(const byte *rowDots, int x)
 {
-  width = 128;
-  height = 32;
+  byte pair = rowDots[x >> 1];
+
+  return (x & 0x01 ? pair >> 4 : pair) & 0x0F;
+}
+
+//-------------------
+// Function: putLevel
+//-------------------
+static inline void putLevel(byte *rowDots, int x, byte level)
+{
+  byte& pair = rowDots[x >> 1];
+
+  if(x & 0x01)
+  {
+    pair = (pair & 0x0F) | ((level & 0x0F) << 4);
+  }
+  else
+  {
+    pair = (pair & 0xF0) | (level & 0x0F);
+  }
+}
+
+//-------------------
+// Function: loadDots
+//-------------------
+static inline uint32_t loadDots(const byte *rowDots, int x)
+{
+  // Eight dots from x as a word of nibbles, the first in the lowest
+  if(!(x & 0x01))
+  {
+    uint32_t word;
+
+    memcpy(&word, &rowDots[x >> 1], sizeof(word));
+    return word;
+  }
+  else
+  {
+    uint64_t word = 0;
+
+    // Odd start, shift the five bytes it spans down a nibble
+    memcpy(&word, &rowDots[x >> 1], 5);
+    return (uint32_t)(word >> 4);
+  }
+}
+
+//-------------------
+// Function: loadMask
+//-------------------
+static inline uint32_t loadMask(const byte *rowMask, int x)
+{
+  // Eight mask bits from x, spanning a second byte when not aligned
+  uint32_t bits = rowMask[x >> 3];
+
+  if(x & 0x07)
+  {
+    bits |= rowMask[(x >> 3) + 1] << 8;
+  }
+
+  return (bits >> (x & 0x07)) & 0xFF;
+}
+
+// Layer clipped to the frame, the dots of its rows from sourceX and sourceY land at destX from destY to endY
+typedef struct tagDmdLayerSpan
+{
+  const DmdLayer *layer;
+  int sourceX;
+  int sourceY;
+  int destX;
+  int destY;
+  int count;
+  int endY;
+} DmdLayerSpan;
+
+template<int width, int height, int scan, int channels>
+DmdPanelFrame<width, height, scan, channels>::DmdPanelFrame()
+{
+  tint = DmdTintWhite;
   Clear();
 }
 
-byte DmdFrame::GetDot(int x, int y)
+template<int width, int height, int scan, int channels>
+int DmdPanelFrame<width, height, scan, channels>::GetWidth()
+{
+  return width;
+}
+
+template<int width, int height, int scan, int channels>
+int DmdPanelFrame<width, height, scan, channels>::GetHeight()
+{
+  return height;
+}
+
+template<int width, int height, int scan, int channels>
+byte DmdPanelFrame<width, height, scan, channels>::GetDot(int x, int y)
 {
   if(!CheckRange(x, y))
   {
     return 0x00;
   }
 
-  return frame.dots[y][x];
+  // Colour dot, the level is that of the brightest channel
+  if(channels > 1)
+  {
+    return max(max(getLevel(frame[0].dots[y], x), getLevel(frame[1].dots[y], x)), getLevel(frame[2].dots[y], x));
+  }
+
+  return getLevel(frame[0].dots[y], x);
 }
 
-void DmdFrame::SetDot(int x, int y, byte value)
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::SetDot(int x, int y, byte value)
 {
   if(!CheckRange(x, y))
   {
     return;
   }
 
-  frame.dots[y][x] = value & 0x0F;
+  if(channels == 1)
+  {
+    putLevel(frame[0].dots[y], x, value);
+  }
+  else
+  {
+    PutDotRgb(x, y, TintRgb(value));
+  }
   return;
 }
 
-void DmdFrame::Clear(byte value)
+template<int width, int height, int scan, int channels>
+uint16_t DmdPanelFrame<width, height, scan, channels>::GetDotRgb(int x, int y)
 {
-  memset(frame.dots, value & 0x0F, sizeof(frame.dots));
+  if(!CheckRange(x, y))
+  {
+    return 0x000;
+  }
+
+  // Mono dot, the level goes to every channel
+  if(channels == 1)
+  {
+    byte level = getLevel(frame[0].dots[y], x);
+
+    return (level << 8) | (level << 4) | level;
+  }
+
+  return (getLevel(frame[0].dots[y], x) << 8) | (getLevel(frame[1].dots[y], x) << 4) | getLevel(frame[2].dots[y], x);
 }
 
-void DmdFrame::DotBlt(Dotmap& dmp, int sourceX, int sourceY, int sourceWidth, int sourceHeight, int destX, int destY)
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::SetDotRgb(int x, int y, uint16_t rgb)
 {
-  int bltSrcX, bltSrcY, bltDestX, bltDestY;
-  
-  for (bltSrcX = sourceX, bltDestX = destX; bltSrcX < (sourceX + sourceWidth); bltSrcX++, bltDestX++)
+  if(!CheckRange(x, y))
   {
-    for(bltSrcY = sourceY, bltDestY = destY; bltSrcY < (sourceY + sourceHeight); bltSrcY++, bltDestY++)
+    return;
+  }
+
+  PutDotRgb(x, y, rgb);
+  return;
+}
+
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::SetTint(byte set)
+{
+  tint = set & DmdTintWhite;
+}
+
+template<int width, int height, int scan, int channels>
+byte DmdPanelFrame<width, height, scan, channels>::GetTint()
+{
+  return tint;
+}
+
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::Clear(byte value)
+{
+  // Both dots of a byte at once, channels outside the tint are cleared
+  for(int channel = 0; channel < channels; channel++)
+  {
+    byte level = (channels == 1 || (tint & (DmdTintRed << channel))) ? value & 0x0F : 0x00;
+
+    memset(frame[channel].dots, level | (level << 4), sizeof(frame[channel].dots));
+  }
+}
+
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::Fill(int x, int y, int fillWidth, int fillHeight, byte value)
+{
+  // Clip to the frame
+  if(x < 0)
+  {
+    fillWidth += x;
+    x = 0;
+  }
+  if(y < 0)
+  {
+    fillHeight += y;
+    y = 0;
+  }
+  fillWidth = min(fillWidth, width - x);
+  fillHeight = min(fillHeight, height - y);
+
+  if(fillWidth <= 0 || fillHeight <= 0)
+  {
+    return;
+  }
+
+  // Channels outside the tint are cleared
+  for(int channel = 0; channel < channels; channel++)
+  {
+    byte level = (channels == 1 || (tint & (DmdTintRed << channel))) ? value & 0x0F : 0x00;
+
+    for(int row = y; row < y + fillHeight; row++)
+    {
+      FillSpan(frame[channel].dots[row], x, fillWidth, level);
+    }
+  }
+}
+
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::DotBlt(Dotmap& dmp, int sourceX, int sourceY, int sourceWidth, int sourceHeight, int destX, int destY)
+{
+  // Nothing to draw, a dotmap without a mask is transparent
+  if(dmp.dots == NULL || dmp.mask == NULL)
+  {
+    return;
+  }
+
+  // Clip to the dotmap
+  if(sourceX < 0)
+  {
+    destX -= sourceX;
+    sourceWidth += sourceX;
+    sourceX = 0;
+  }
+  if(sourceY < 0)
+  {
+    destY -= sourceY;
+    sourceHeight += sourceY;
+    sourceY = 0;
+  }
+  sourceWidth = min(sourceWidth, dmp.width - sourceX);
+  sourceHeight = min(sourceHeight, dmp.height - sourceY);
+
+  // Clip to the frame, scenes are drawn for 128x32 and may fall off a smaller one
+  if(destX < 0)
+  {
+    sourceX -= destX;
+    sourceWidth += destX;
+    destX = 0;
+  }
+  if(destY < 0)
+  {
+    sourceY -= destY;
+    sourceHeight += destY;
+    destY = 0;
+  }
+  sourceWidth = min(sourceWidth, width - destX);
+  sourceHeight = min(sourceHeight, height - destY);
+
+  if(sourceWidth <= 0 || sourceHeight <= 0)
+  {
+    return;
+  }
+
+  // Row by row, so both the dotmap and the frame are walked in memory order
+  for(int y = 0; y < sourceHeight; y++)
+  {
+    const byte *rowDots = &dmp.dots[(sourceY + y) * dmp.widthBytesDots];
+    const byte *rowMask = &dmp.mask[(sourceY + y) * dmp.widthBytesMask];
+
+    // Rows without a transparent dot skip the mask
+    if(IsSpanOpaque(rowMask, sourceX, sourceWidth))
     {
-      byte bltDot ;
+      rowMask = NULL;
+    }
 
-      // Apply mask
-      if(dmp.GetMask(bltSrcX, bltSrcY))
+    if(dmp.bpp == Dotmap::BppRgb)
+    {
+      // Colour dotmaps keep their own colour, or their brightness in a mono frame
+      for(int channel = 0; channel < channels; channel++)
       {
-        bltDot = frame.dots[bltDestY][bltDestX];
+        BltSpanRgb(frame[channel].dots[destY + y], destX, rowDots, rowMask, sourceX, sourceWidth, channel);
       }
-      else
+      continue;
+    }
+
+    // Mono dots go to the channels of the tint
+    for(int channel = 0; channel < channels; channel++)
+    {
+      bool inTint = (channels == 1 || (tint & (DmdTintRed << channel)));
+
+      BltSpan(frame[channel].dots[destY + y], destX, rowDots, rowMask, sourceX, sourceWidth, inTint ? 0xFFFFFFFF : 0x00000000);
+    }
+  }
+}
+
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::Composite(const DmdLayer *layers, int cntLayers, byte background)
+{
+  DmdLayerSpan spans[DmdLayersMax];
+  int cntSpans = 0;
+
+  // Clip each layer to the frame once and order them lowest first, those of equal z as given
+  for(int idxLayer = 0; idxLayer < cntLayers && cntSpans < DmdLayersMax; idxLayer++)
+  {
+    const DmdLayer& layer = layers[idxLayer];
+    DmdLayerSpan span;
+    int idxSpan;
+
+    // Nothing to draw, a masked layer without a mask is transparent
+    if(layer.dmp == NULL || layer.dmp->dots == NULL || (layer.isMasked && layer.dmp->mask == NULL))
+    {
+      continue;
+    }
+
+    span.layer = &layer;
+    span.sourceX = max(0, -layer.x);
+    span.sourceY = max(0, -layer.y);
+    span.destX = max(0, layer.x);
+    span.destY = max(0, layer.y);
+    span.count = min(layer.dmp->width - span.sourceX, width - span.destX);
+    span.endY = min(layer.y + layer.dmp->height, height);
+
+    if(span.count <= 0 || span.destY >= span.endY)
+    {
+      continue;
+    }
+
+    for(idxSpan = cntSpans; idxSpan > 0 && spans[idxSpan - 1].layer->z > layer.z; idxSpan--)
+    {
+      spans[idxSpan] = spans[idxSpan - 1];
+    }
+    spans[idxSpan] = span;
+    cntSpans++;
+  }
+
+  // Each row is built up from the background in a buffer and written to the frame once
+  for(int y = 0; y < height; y++)
+  {
+    const byte *rowsDots[DmdLayersMax];
+    const byte *rowsMask[DmdLayersMax];
+
+    // Rows of the layers that cross this one, those without a transparent dot skip the mask
+    for(int idxSpan = 0; idxSpan < cntSpans; idxSpan++)
+    {
+      const DmdLayerSpan& span = spans[idxSpan];
+      Dotmap& dmp = *span.layer->dmp;
+      int ySource = span.sourceY + y - span.destY;
+
+      rowsDots[idxSpan] = NULL;
+      if(y < span.destY || y >= span.endY)
+      {
+        continue;
+      }
+
+      rowsDots[idxSpan] = &dmp.dots[ySource * dmp.widthBytesDots];
+      rowsMask[idxSpan] = (span.layer->isMasked ? &dmp.mask[ySource * dmp.widthBytesMask] : NULL);
+      if(rowsMask[idxSpan] != NULL && IsSpanOpaque(rowsMask[idxSpan], span.sourceX, span.count))
+      {
+        rowsMask[idxSpan] = NULL;
+      }
+    }
+
+    for(int channel = 0; channel < channels; channel++)
+    {
+      bool inTint = (channels == 1 || (tint & (DmdTintRed << channel)));
+      byte level = (inTint ? background & 0x0F : 0x00);
+      byte row[width / 2];
+
+      memset(row, level | (level << 4), sizeof(row));
+
+      for(int idxSpan = 0; idxSpan < cntSpans; idxSpan++)
       {
-        bltDot = dmp.GetDot(bltSrcX, bltSrcY);
+        const DmdLayerSpan& span = spans[idxSpan];
+
+        if(rowsDots[idxSpan] == NULL)
+        {
+          continue;
+        }
+
+        if(span.layer->dmp->bpp == Dotmap::BppRgb)
+        {
+          // Colour dotmaps keep their own colour, or their brightness in a mono frame
+          BltSpanRgb(row, span.destX, rowsDots[idxSpan], rowsMask[idxSpan], span.sourceX, span.count, channel);
+        }
+        else
+        {
+          // Mono dots go to the channels of the tint
+          BltSpan(row, span.destX, rowsDots[idxSpan], rowsMask[idxSpan], span.sourceX, span.count, inTint ? 0xFFFFFFFF : 0x00000000);
+        }
       }
 
-      // Set dot
-      frame.dots[bltDestY][bltDestX] = bltDot;
+      memcpy(frame[channel].dots[y], row, sizeof(row));
     }
   }
 }
@@ -69,7 +412,8 @@ void DmdFrame::DotBlt(Dotmap& dmp, int sourceX, int sourceY, int sourceWidth, in
 //---------------------
 // Function: CheckRange
 //---------------------
-bool DmdFrame::CheckRange(int x, int y)
+template<int width, int height, int scan, int channels>
+bool DmdPanelFrame<width, height, scan, channels>::CheckRange(int x, int y)
 {
   if(x < 0 || y < 0 || x >= width || y >= height)
   {
@@ -82,3 +426,179 @@ bool DmdFrame::CheckRange(int x, int y)
   }
 }
 
+//-----------------------
+// Function: IsSpanOpaque
+//-----------------------
+template<int width, int height, int scan, int channels>
+bool DmdPanelFrame<width, height, scan, channels>::IsSpanOpaque(const byte *rowMask, int x, int count)
+{
+  // Dots up to a whole mask byte
+  for(; count > 0 && (x & 0x07); x++, count--)
+  {
+    if(rowMask[x >> 3] & (1 << (x & 0x07)))
+    {
+      return false;
+    }
+  }
+
+  // Eight dots a byte
+  for(; count >= 8; x += 8, count -= 8)
+  {
+    if(rowMask[x >> 3])
+    {
+      return false;
+    }
+  }
+
+  // Dots left over
+  if(count > 0 && (rowMask[x >> 3] & ((1 << count) - 1)))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+//------------------
+// Function: BltSpan
+//------------------
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::BltSpan(byte *dest, int destX, const byte *rowDots, const byte *rowMask, int x, int count, uint32_t levelMask)
+{
+  // Odd start, the high nibble of its byte
+  if(count > 0 && (destX & 0x01))
+  {
+    if(rowMask == NULL || !(rowMask[x >> 3] & (1 << (x & 0x07))))
+    {
+      putLevel(dest, destX, getLevel(rowDots, x) & levelMask);
+    }
+    destX++;
+    x++;
+    count--;
+  }
+
+  // Eight dots a word, transparent dots keep the frame's
+  for(; count >= 8; destX += 8, x += 8, count -= 8)
+  {
+    uint32_t transparent = (rowMask == NULL ? 0x00000000 : nibbleMask(loadMask(rowMask, x)));
+    uint32_t word;
+
+    if(transparent == 0xFFFFFFFF)
+    {
+      continue;
+    }
+
+    memcpy(&word, &dest[destX >> 1], sizeof(word));
+    word = (word & transparent) | (loadDots(rowDots, x) & levelMask & ~transparent);
+    memcpy(&dest[destX >> 1], &word, sizeof(word));
+  }
+
+  // Dots left over
+  for(; count > 0; destX++, x++, count--)
+  {
+    if(rowMask == NULL || !(rowMask[x >> 3] & (1 << (x & 0x07))))
+    {
+      putLevel(dest, destX, getLevel(rowDots, x) & levelMask);
+    }
+  }
+}
+
+//---------------------
+// Function: BltSpanRgb
+//---------------------
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::BltSpanRgb(byte *dest, int destX, const byte *rowDots, const byte *rowMask, int x, int count, int channel)
+{
+  // Level of the channel from each little endian 0x0RGB word, a mono frame takes that of the brightest
+  int shift = (2 - channel) * 4;
+
+  for(; count > 0; destX++, x++, count--)
+  {
+    if(rowMask == NULL || !(rowMask[x >> 3] & (1 << (x & 0x07))))
+    {
+      uint16_t rgb = rowDots[x * 2] | (rowDots[(x * 2) + 1] << 8);
+
+      if(channels == 1)
+      {
+        putLevel(dest, destX, max(max((rgb >> 8) & 0x0F, (rgb >> 4) & 0x0F), rgb & 0x0F));
+      }
+      else
+      {
+        putLevel(dest, destX, rgb >> shift);
+      }
+    }
+  }
+}
+
+//-------------------
+// Function: FillSpan
+//-------------------
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::FillSpan(byte *dest, int x, int count, byte level)
+{
+  // Odd start, the high nibble of its byte
+  if(count > 0 && (x & 0x01))
+  {
+    putLevel(dest, x, level);
+    x++;
+    count--;
+  }
+
+  // Both dots of a byte at once
+  memset(&dest[x >> 1], level | (level << 4), count >> 1);
+  x += count & ~0x01;
+
+  // Dot left over, the low nibble of its byte
+  if(count & 0x01)
+  {
+    putLevel(dest, x, level);
+  }
+}
+
+//------------------
+// Function: TintRgb
+//------------------
+template<int width, int height, int scan, int channels>
+uint16_t DmdPanelFrame<width, height, scan, channels>::TintRgb(byte value)
+{
+  uint16_t rgb = 0x000;
+
+  // Mono level in the channels of the tint
+  value &= 0x0F;
+  if(channels == 1 || (tint & DmdTintRed))
+  {
+    rgb |= value << 8;
+  }
+  if(channels == 1 || (tint & DmdTintGreen))
+  {
+    rgb |= value << 4;
+  }
+  if(channels == 1 || (tint & DmdTintBlue))
+  {
+    rgb |= value;
+  }
+
+  return rgb;
+}
+
+//--------------------
+// Function: PutDotRgb
+//--------------------
+template<int width, int height, int scan, int channels>
+void DmdPanelFrame<width, height, scan, channels>::PutDotRgb(int x, int y, uint16_t rgb)
+{
+  if(channels == 1)
+  {
+    // Mono frame, the level is that of the brightest channel
+    putLevel(frame[0].dots[y], x, max(max((rgb >> 8) & 0x0F, (rgb >> 4) & 0x0F), rgb & 0x0F));
+  }
+  else
+  {
+    putLevel(frame[0].dots[y], x, rgb >> 8);
+    putLevel(frame[1].dots[y], x, rgb >> 4);
+    putLevel(frame[2].dots[y], x, rgb);
+  }
+}
+
+// Frame of the configured display geometry
+template class DmdPanelFrame<DmdWidth, DmdHeight, DmdScan, DmdChannels>;
@@ -3,25 +3,72 @@
 
 #include <Arduino.h>
 #include "DmdFrameRaw.h"
+#include "DmdGeometry.h"
 #include "Dotmap.h"
 
-class DmdFrame
+template<class Pinout> class Dmd;
+
+// Tint of mono dots in a colour frame, a bit per channel
+enum {
+  DmdTintRed = 0x01,
+  DmdTintGreen = 0x02,
+  DmdTintBlue = 0x04,
+  DmdTintWhite = 0x07,
+};
+
+// Dotmap composited into a frame at x, y, layers with a higher z are drawn above those with a lower one
+// and unmasked layers draw every dot, whatever their mask holds
+typedef struct tagDmdLayer
+{
+  Dotmap *dmp;
+  int x;
+  int y;
+  int z;
+  bool isMasked;
+} DmdLayer;
+
+const int DmdLayersMax = 8;
+
+// Frame sized for its panels at compile time, scan is the rows of each half a row address selects between
+// A colour frame has a level per red, green and blue channel, mono dots are drawn in the tint
+// Dots are packed two a byte as in a Dotmap, the blits work on eight at a time
+template<int width, int height, int scan, int channels>
+class DmdPanelFrame
 {
+  static_assert(height % (scan * 2) == 0, "Frame height must be a whole number of scanned panels");
+  static_assert(channels == 1 || channels == 3, "Frame is mono or red, green and blue");
+
   private:
-    DmdFrameRaw frame;
-    int width;
-    int height;
+    DmdFrameRaw<width, height> frame[channels];
+    byte tint;
 
     bool CheckRange(int x, int y);
+    uint16_t TintRgb(byte value);
+    void PutDotRgb(int x, int y, uint16_t rgb);
+    bool IsSpanOpaque(const byte *rowMask, int x, int count);
+    void BltSpan(byte *dest, int destX, const byte *rowDots, const byte *rowMask, int x, int count, uint32_t levelMask);
+    void BltSpanRgb(byte *dest, int destX, const byte *rowDots, const byte *rowMask, int x, int count, int channel);
+    void FillSpan(byte *dest, int x, int count, byte level);
     
   public:
-    DmdFrame();
+    DmdPanelFrame();
+    int GetWidth();
+    int GetHeight();
     byte GetDot(int x, int y);
     void SetDot(int x, int y, byte value);
+    uint16_t GetDotRgb(int x, int y);
+    void SetDotRgb(int x, int y, uint16_t rgb);
+    void SetTint(byte tint);
+    byte GetTint();
     void Clear(byte value = 0x00);
+    void Fill(int x, int y, int fillWidth, int fillHeight, byte value);
     void DotBlt(Dotmap& dmp, int sourceX, int sourceY, int sourceWidth, int sourceHeight, int destX, int destY);
+    void Composite(const DmdLayer *layers, int cntLayers, byte background = 0x00);
 
-    friend class Dmd;
+    template<class Pinout> friend class Dmd;
 };
 
+// Frame of the configured display geometry
+typedef DmdPanelFrame<DmdWidth, DmdHeight, DmdScan, DmdChannels> DmdFrame;
+
 #endif
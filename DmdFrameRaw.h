@@ -1,13 +1,14 @@
 #ifndef __DMDFRAMERAW_H__
 #define __DMDFRAMERAW_H__
 
-typedef byte DmdFrameRow[128];
-
+// Two dots a byte, the even dot in the low nibble as in a Dotmap
+template<int width, int height>
 class DmdFrameRaw
 {
+  static_assert(width % 2 == 0, "Frame width must be a whole number of bytes");
+
   public:
-    DmdFrameRow dots[32];
+    byte dots[height][width / 2];
 };
 
 #endif
-
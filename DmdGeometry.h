@@ -0,0 +1,146 @@
+#ifndef __DMDGEOMETRY_H__
+#define __DMDGEOMETRY_H__
+
+// Display geometry, one or two chains of panels
+// DMD_128X32 - a single 128x32 chain
+// DMD_64X32  - a single 64x32 chain
+// DMD_128X16 - a single 128x16 chain
+// DMD_256X32 - two 128x32 chains side by side, the second to the right of the first
+// DMD_128X64 - two 128x32 chains stacked, the second below the first
+// DMD_192X64 - two 192x32 chains stacked
+// A build may select one on its command line instead
+#if !defined(DMD_128X32) && !defined(DMD_64X32) && !defined(DMD_128X16) && !defined(DMD_256X32) && !defined(DMD_128X64) && !defined(DMD_192X64)
+#define DMD_128X32
+#endif
+
+#if defined(DMD_128X32) + defined(DMD_64X32) + defined(DMD_128X16) + defined(DMD_256X32) + defined(DMD_128X64) + defined(DMD_192X64) != 1
+  #error Only one display geometry can be selected
+#endif
+
+// A chain is scanned as a top and bottom half, each clock pulse carries a dot of both
+#ifdef DMD_128X32
+const int DmdChainWidth = 128;
+const int DmdChainHeight = 32;
+const int DmdChains = 1;
+const bool DmdChainsStacked = false;
+#endif
+
+#ifdef DMD_64X32
+const int DmdChainWidth = 64;
+const int DmdChainHeight = 32;
+const int DmdChains = 1;
+const bool DmdChainsStacked = false;
+#endif
+
+#ifdef DMD_128X16
+const int DmdChainWidth = 128;
+const int DmdChainHeight = 16;
+const int DmdChains = 1;
+const bool DmdChainsStacked = false;
+#endif
+
+#ifdef DMD_256X32
+const int DmdChainWidth = 128;
+const int DmdChainHeight = 32;
+const int DmdChains = 2;
+const bool DmdChainsStacked = false;
+#endif
+
+#ifdef DMD_128X64
+const int DmdChainWidth = 128;
+const int DmdChainHeight = 32;
+const int DmdChains = 2;
+const bool DmdChainsStacked = true;
+#endif
+
+#ifdef DMD_192X64
+const int DmdChainWidth = 192;
+const int DmdChainHeight = 32;
+const int DmdChains = 2;
+const bool DmdChainsStacked = true;
+#endif
+
+// Scan multiplex of a chain, select one
+// DMD_SCAN_16 - 1/16, a row address drives a row of each half of a 32 high chain
+// DMD_SCAN_8  - 1/8, a row address drives a row of each half of a 16 high chain, or two of a 32 high one
+// DMD_SCAN_4  - 1/4, a row address drives two rows of each half of a 16 high chain, or four of a 32 high one
+#if !defined(DMD_SCAN_16) && !defined(DMD_SCAN_8) && !defined(DMD_SCAN_4)
+#define DMD_SCAN_16
+#endif
+
+#if defined(DMD_SCAN_16) + defined(DMD_SCAN_8) + defined(DMD_SCAN_4) != 1
+  #error Only one scan multiplex can be selected
+#endif
+
+#ifdef DMD_SCAN_16
+const int DmdScan = 16;
+#endif
+
+#ifdef DMD_SCAN_8
+const int DmdScan = 8;
+#endif
+
+#ifdef DMD_SCAN_4
+const int DmdScan = 4;
+#endif
+
+// Four row address lines
+static_assert(DmdScan <= 16, "Scan must fit the row address lines");
+static_assert((DmdChainHeight / 2) % DmdScan == 0, "A chain half must be a whole number of scans");
+
+// Rows of a half each row address drives
+const int DmdScanRows = (DmdChainHeight / 2) / DmdScan;
+
+// Order the rows of a row address take turns in, and the order their blocks run along the chain
+enum {
+  DmdRowsTopFirst = 0,
+  DmdRowsBottomFirst,
+  DmdRowsAlternate,
+};
+
+enum {
+  DmdBlocksLeftFirst = 0,
+  DmdBlocksRightFirst,
+};
+
+// Scan descriptor, how the panel wiring orders the dots of a row address along the chain
+// They are shifted out a block of one row at a time, the rows taking turns in row order for each block,
+// and the blocks run along the chain in block order, alternating rows start every other block bottom first
+template<int blockDots, int rows, int blocks>
+struct DmdScanDescriptor
+{
+  static const int block = blockDots;
+  static const int rowOrder = rows;
+  static const int blockOrder = blocks;
+};
+
+// Panel wiring as block size, row order, block order, blocks of 8 top row first suit most 1/8 and 1/4 panels
+#ifndef DMD_SCAN_WIRING
+#define DMD_SCAN_WIRING 8, DmdRowsTopFirst, DmdBlocksLeftFirst
+#endif
+
+typedef DmdScanDescriptor<DMD_SCAN_WIRING> DmdScanOrder;
+static_assert(DmdChainWidth % DmdScanOrder::block == 0, "A chain must be a whole number of scan blocks");
+
+// Each clock pulse carries its own column of the row address's row unless the wiring says otherwise
+const bool DmdScanMapped = (DmdScanRows > 1 || DmdScanOrder::blockOrder != DmdBlocksLeftFirst);
+
+// Clock pulses to shift out a row address
+const int DmdScanPulses = DmdChainWidth * DmdScanRows;
+
+// Frame format, define for a 4 bit level per red, green and blue channel of each dot
+// Otherwise a dot has a single level and the whole screen shares the Dmd colour
+// Needs a screen with blue lines for the full palette
+//#define DMD_RGB
+
+#ifdef DMD_RGB
+const int DmdChannels = 3;
+#else
+const int DmdChannels = 1;
+#endif
+
+// Whole display
+const int DmdWidth = DmdChainsStacked ? DmdChainWidth : DmdChainWidth * DmdChains;
+const int DmdHeight = DmdChainsStacked ? DmdChainHeight * DmdChains : DmdChainHeight;
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __DMDNIBBLES_H__
+#define __DMDNIBBLES_H__
+
+#include <Arduino.h>
+
+// Eight mask bits spread to the nibbles of eight dots, for the blits to merge a word of dots at a time
+// Cores with the DSP extension select whole bytes with USUB8 and SEL, others shift and mask, both forms are
+// built everywhere so either can be checked against the other, the DSP one by emulating the two instructions
+// off target
+
+#if defined(__ARM_FEATURE_DSP)
+//----------------------
+// Function: selectBytes
+//----------------------
+static inline uint32_t selectBytes(uint32_t bytes, uint32_t set, uint32_t clear)
+{
+  uint32_t ret;
+
+  // USUB8 from zero flags the zero bytes, SEL takes clear for those and set for the rest, kept in one
+  // statement so nothing can touch the flags in between
+  asm("usub8 %0, %1, %2\n\t"
+      "sel %0, %3, %4"
+      : "=&r" (ret)
+      : "r" (0), "r" (bytes), "r" (clear), "r" (set)
+      : "cc");
+
+  return ret;
+}
+#else
+//----------------------
+// Function: selectBytes
+//----------------------
+static inline uint32_t selectBytes(uint32_t bytes, uint32_t set, uint32_t clear)
+{
+  uint32_t ret = 0;
+
+  // USUB8 from zero sets a byte's GE flag where it does not borrow, only for a zero byte, and SEL takes the
+  // byte of its first operand, clear, where the flag is set
+  for(int lane = 0; lane < 4; lane++)
+  {
+    uint32_t maskLane = 0xFFu << (lane * 8);
+    bool isGe = (bytes & maskLane) == 0;
+
+    ret |= (isGe ? clear : set) & maskLane;
+  }
+
+  return ret;
+}
+#endif
+
+//------------------------
+// Function: nibbleMaskDsp
+//------------------------
+static inline uint32_t nibbleMaskDsp(uint32_t bits)
+{
+  // Each byte takes the bits of its two dots, then is filled a nibble per bit set
+  uint32_t bytes = bits * 0x01010101;
+  uint32_t low = selectBytes(bytes & 0x40100401, 0x0F0F0F0F, 0x00000000);
+
+  return selectBytes(bytes & 0x80200802, low | 0xF0F0F0F0, low);
+}
+
+//-----------------------------
+// Function: nibbleMaskPortable
+//-----------------------------
+static inline uint32_t nibbleMaskPortable(uint32_t bits)
+{
+  // Spread eight bits to the bottom bit of each nibble, then fill the nibbles
+  bits = (bits | (bits << 12)) & 0x000F000F;
+  bits = (bits | (bits << 6)) & 0x03030303;
+  bits = (bits | (bits << 3)) & 0x11111111;
+
+  return bits * 0x0F;
+}
+
+//---------------------
+// Function: nibbleMask
+//---------------------
+static inline uint32_t nibbleMask(uint32_t bits)
+{
+#if defined(__ARM_FEATURE_DSP)
+  return nibbleMaskDsp(bits);
+#else
+  return nibbleMaskPortable(bits);
+#endif
+}
+
+#endif
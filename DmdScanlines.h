@@ -0,0 +1,85 @@
+#ifndef __DMDSCANLINES_H__
+#define __DMDSCANLINES_H__
+
+#include <type_traits>
+
+#include "DmdGeometry.h"
+
+// Lane bits of a scanline code, one per data line of the screen
+enum {
+  DmdLaneR1 = 0x01,
+  DmdLaneG1 = 0x02,
+  DmdLaneB1 = 0x04,
+  DmdLaneR2 = 0x08,
+  DmdLaneG2 = 0x10,
+  DmdLaneB2 = 0x20,
+  DmdLaneR3 = 0x40,
+  DmdLaneG3 = 0x80,
+  DmdLaneB3 = 0x100,
+  DmdLaneR4 = 0x200,
+  DmdLaneG4 = 0x400,
+  DmdLaneB4 = 0x800,
+};
+
+// Each chain has six lanes, the second chain's lanes sit above the first's
+const int DmdLanesChain = 6;
+const int DmdLaneCodes = 64;
+const int DmdPortsMax = 5;
+const int DmdQueueSlots = 4;
+const int DmdCommandSlots = 8;
+const int DmdWordBanks = 2;
+const int DmdPlanesMin = 2;
+const int DmdPlanesMax = 6;
+
+// Lane code of a clock pulse, wide enough for the lanes of every chain
+typedef std::conditional<(DmdChains > 1), uint16_t, byte>::type DmdLaneCode;
+
+// One scanline of lane codes, one code per clock pulse, the chains are shifted together
+typedef DmdLaneCode DmdScanRow[DmdScanPulses];
+
+// One bit-plane, a scanline for every row address
+typedef DmdScanRow DmdScanPlane[DmdScan];
+
+// Plane pool of the queued frames, two frames at the most planes, 12KB to 72KB
+const int DmdQueuePlanes = DmdPlanesMax * 2;
+const int DmdQueueBytesMax = 72 * 1024;
+static_assert(sizeof(DmdScanPlane) * DmdQueuePlanes <= DmdQueueBytesMax, "Plane pool must fit its RAM budget");
+
+// Compiled frame, plane timings and pool position, counted twice round the pool
+class DmdScanlines
+{
+  public:
+    int cntPlanes;
+    uint16_t microsPlanes[DmdPlanesMax];
+    float microsOn[DmdPlanesMax];
+    int posPlanes;
+};
+
+// Dot of a chain's top half that a clock pulse of a row address carries
+struct DmdScanDot
+{
+  byte x;
+  byte y;
+};
+
+// A GPIO port driven by the scanout, with its output word for every lane code of each chain
+// The words are banked, a change is compiled into the bank not in use and the scanout switches over
+struct DmdPort
+{
+  volatile uint32_t *regSet;
+  volatile uint32_t *regClear;
+  uint32_t maskClear;
+  uint32_t maskLane[DmdLanesChain * DmdChains];
+  uint32_t words[DmdWordBanks][DmdChains][DmdLaneCodes];
+};
+
+// Port layout of the data lines and clock, the clock's port first
+struct DmdPortLayout
+{
+  int cntPorts;
+  DmdPort ports[DmdPortsMax];
+  volatile uint32_t *regClockSet;
+  uint32_t maskClock;
+};
+
+#endif
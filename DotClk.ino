@@ -25,41 +25,22 @@ enum MODE {
 
 typedef char FILENAME[8+1+3+1];
 
+// Scene frames are read this far ahead of their due time and queued on the DMD
+const unsigned long millisSceneLookahead = 20;
+
+// Longest wait for the DMD refresh when pacing the clock, in microseconds
+const uint32_t microsRefreshTimeout = 50000;
+
 // Pin Assignments
+// Screen pins are held in the Dmd pinout, see Pinout.h
 // HUB08
 #ifdef HUB08
-const int pinEN = 19 ; // B2
-const int pinR1 = 20 ; // D5
-const int pinR2 = 21 ; // D6
-const int pinG1 = 17 ; // B1
-const int pinG2 = 18 ; // B3
-const int pinB1 = 22 ;
-const int pinB2 = 23 ;
-const int pinLA = 7 ;  // D2
-const int pinLB = 6 ;  // D4
-const int pinLC = 5 ;  // D7
-const int pinLD = 4 ;  // A13
-const int pinLT = 1 ;  // B17
-const int pinSK = 0 ;  // B16
 const int pinLED = 13;
 const int pinGND[] = { 2, 3, 16, 17, 18, 22, 23 } ;
 #endif
 
 #ifdef HUB75
 // HUB75
-const int pinEN = 23; // A9
-const int pinR1 = 16; // A2
-const int pinR2 = 18; // A4
-const int pinG1 = 17;  // A3
-const int pinG2 = 19;  // A5
-const int pinB1 = 7;  // 
-const int pinB2 = 5;  // 
-const int pinLA = 20;  // A6
-const int pinLB = 3;  // 
-const int pinLC = 21;  // A7 
-const int pinLD = 2;  // 
-const int pinLT = 1;  // 
-const int pinSK = 22;  // A8
 const int pinLED = 13;
 const int pinGND[] = { 6, 4, 0 } ;
 #endif
@@ -127,7 +108,7 @@ void setup()
 
   // Initialise the DMD
   dmd.SetDmdType(config.GetCfgItems().cfgDmdType);
-  dmd.Initialise(pinEN, pinR1, pinR2, pinG1, pinG2, pinB1, pinB2, pinLA, pinLB, pinLC, pinLD, pinLT, pinSK);
+  dmd.Initialise();
 
   // Set DMD brightness from config
   dmd.SetBrightness(config.GetCfgItems().cfgBrightness);
@@ -135,12 +116,19 @@ void setup()
   // Set DMD colour from config
   colourControl.SetColour(config.GetCfgItems().cfgDotColour);
 
+  // Set DMD gamma and planes from config, curves need the extra planes to tell their darker levels apart
+  SetDmdGamma(config.GetCfgItems().cfgGamma);
+  SetDmdPlanes(config.GetCfgItems().cfgPlanes);
+
   // Start the DMD
   dmd.Start();
 
   // Show boot screen
   ShowBootScreen();
 
+  // Calibrate the DMD plane timings against a profile of the row updates
+  dmd.Calibrate(hzDmdRefresh);
+
   // Set up RTC
   setSyncProvider(getTeensy3Time);
   setSyncInterval(60); // Seconds
@@ -176,10 +164,14 @@ void setup()
 void loop()
 {
   static int mode = modeClock;
+  static bool isClockInit = true;
   
   time_t tNow = NowDST();
   time_t tWake = config.GetCfgItems().cfgWakeTime;
 
+  // Step the changing colour and colour effects, they are applied as frames are presented
+  colourControl.Update();
+
   // Reset the forceWake
   if(forceWake && hour(tNow) == hour(tWake) && minute(tNow) == minute(tWake))
   {
@@ -217,7 +209,8 @@ void loop()
         else
         {
           // Clock mode
-          doClock();
+          doClock(isClockInit);
+          isClockInit = false;
         }
       }
       break;
@@ -227,6 +220,7 @@ void loop()
       {
         // Returning from Setup mode
         mode = modeClock;
+        isClockInit = true;
 
         // Need to force a refresh of the clock font as it may have been changed by the user
         InitClockFont();
@@ -240,6 +234,7 @@ void loop()
 
         // From Off mode to Clock mode
         mode = modeClock;
+        isClockInit = true;
         dmd.Start();
       }
       break ;
@@ -262,6 +257,7 @@ void loop()
       {
         // From Sleep mode to Clock mode
         mode = modeClock;
+        isClockInit = true;
         dmd.Start();
       }
       
@@ -278,7 +274,7 @@ void loop()
 //------------------
 // Function: doClock
 //------------------
-void doClock()
+void doClock(bool isInit)
 {
   static FsFile fileScene ;
   static Scene scene;
@@ -287,13 +283,22 @@ void doClock()
   static uint16_t curScene = 0;
   static unsigned long sceneStart = 0, sceneDuration = 0;
   static unsigned long cfgClockDelayValue = 0;
+  static uint32_t cntSceneFrames = 0;
+  static char shown[63 + 1] = "";
   
-  DmdFrame frame;
+  DmdFrame& frame = dmd.AcquireBackBuffer();
   Dotmap dmpFrame ;
   Dotmap dmpClock;
+  Dotmap dmpText ;
+  Dotmap dmpStats ;
+  DmdLayer layers[DmdLayersMax];
+  int cntLayers = 0;
   unsigned long millisNow = millis();
+  unsigned long millisDue = millisNow;
   const char *blanking;
   char clock[15 + 1];
+  char showing[63 + 1];
+  bool isSceneShown = false;
   time_t timeNow = NowDST();
   ConfigItems cfgItems = config.GetCfgItems();
   
@@ -384,18 +389,15 @@ void doClock()
     fontClock->DmpFromString(dmpClock, clock, blanking);
 
     // Only showing the clock between animations
-    frame.Clear();
-    frame.DotBlt(dmpClock, 0, 0, dmpClock.GetWidth(), dmpClock.GetHeight(), (127 - dmpClock.GetWidth()) / 2, (31 - dmpClock.GetHeight())/2);
+    layers[cntLayers++] = {&dmpClock, (frame.GetWidth() - 1 - dmpClock.GetWidth()) / 2, (frame.GetHeight() - 1 - dmpClock.GetHeight())/2, 0, true};
 
     if(cfgItems.cfgDebug != 0)
     {
       char textDurn[20 + 1];
-      Dotmap dmpDuration ;
       
       sprintf(textDurn, "%lu", sceneDuration);
-      fontSystem.DmpFromString(dmpDuration, textDurn);
-      dmpDuration.ClearMask();
-      frame.DotBlt(dmpDuration, 0, 0, dmpDuration.GetWidth(), dmpDuration.GetHeight(), 0, 0);         
+      fontSystem.DmpFromString(dmpText, textDurn);
+      layers[cntLayers++] = {&dmpText, 0, 0, 1, false};
     }
   }
   else
@@ -405,8 +407,8 @@ void doClock()
       sceneStart = millis();
     }
     
-    // Get the next scene frame?
-    if(millisSceneFrameDelay == 0 || millisNow - millisSceneFrameDelay > scene.GetFrameDelay())
+    // Get the next scene frame? Read ahead of time so it can be queued for when it is due
+    if(millisSceneFrameDelay == 0 || (long)(millisNow + millisSceneLookahead - millisSceneFrameDelay) > (long)scene.GetFrameDelay())
     {
       // At the end of the scene?
       if(!scene.Eof())
@@ -424,6 +426,7 @@ void doClock()
 
         // First frame or next frame
         scene.NextFrame(fileScene);
+        cntSceneFrames++;
       }
       else
       {
@@ -442,6 +445,12 @@ void doClock()
     {
       int xClock, yClock;
 
+      // Present the frame when it is due
+      if((long)(millisSceneFrameDelay - millisNow) > 0)
+      {
+        millisDue = millisSceneFrameDelay;
+      }
+
       // Generate clock dotmap
       switch(scene.GetClockStyle())
       {
@@ -449,8 +458,8 @@ void doClock()
         case Scene::ClockStyleStd:
           // Generate clock dotmap
           fontClock->DmpFromString(dmpClock, clock, blanking);
-          xClock = (127 - dmpClock.GetWidth()) / 2;
-          yClock = (31 - dmpClock.GetHeight()) / 2;
+          xClock = (frame.GetWidth() - 1 - dmpClock.GetWidth()) / 2;
+          yClock = (frame.GetHeight() - 1 - dmpClock.GetHeight()) / 2;
           break;
 
         case Scene::ClockStyleCustom:
@@ -463,23 +472,15 @@ void doClock()
 
       // Get the frame dotmap
       dmpFrame = scene.GetFrameDotmap();
-      if(scene.GetFrameLayer() == 0)
-      {
-        // Clock sits behind the animation frame
-        frame.DotBlt(dmpClock, 0, 0, dmpClock.GetWidth(), dmpClock.GetHeight(), xClock, yClock);
-        frame.DotBlt(dmpFrame, 0, 0, dmpFrame.GetWidth(), dmpFrame.GetHeight(), 0, 0);
-      }
-      else
-      {
-        // Clock sits above the animation frame
-        frame.DotBlt(dmpFrame, 0, 0, dmpFrame.GetWidth(), dmpFrame.GetHeight(), 0, 0);
-        frame.DotBlt(dmpClock, 0, 0, dmpClock.GetWidth(), dmpClock.GetHeight(), xClock, yClock);
-      }
+      layers[cntLayers++] = {&dmpFrame, 0, 0, 1, true};
+      isSceneShown = true;
+
+      // Clock sits behind or above the animation frame
+      layers[cntLayers++] = {&dmpClock, xClock, yClock, scene.GetFrameLayer() == 0 ? 0 : 2, true};
 
       // If debug on, display the scene file name in the top left
       if(cfgItems.cfgDebug != 0 && fileScene.isOpen())
       {
-        Dotmap dmpFilename ;
         FILENAME sceneName ;
         char *dot ;
 
@@ -491,9 +492,8 @@ void doClock()
           *dot = '\0';
         }
         
-        fontSystem.DmpFromString(dmpFilename, sceneName);
-        dmpFilename.ClearMask();
-        frame.DotBlt(dmpFilename, 0, 0, dmpFilename.GetWidth(), dmpFilename.GetHeight(), 0, 0);          
+        fontSystem.DmpFromString(dmpText, sceneName);
+        layers[cntLayers++] = {&dmpText, 0, 0, 3, false};
       }
     }
     else
@@ -510,13 +510,53 @@ void doClock()
       fontClock->DmpFromString(dmpClock, clock, blanking);
   
       // Only showing the clock between animations
-      frame.Clear();
-      frame.DotBlt(dmpClock, 0, 0, dmpClock.GetWidth(), dmpClock.GetHeight(), (127 - dmpClock.GetWidth()) / 2, (31 - dmpClock.GetHeight())/2);
+      layers[cntLayers++] = {&dmpClock, (frame.GetWidth() - 1 - dmpClock.GetWidth()) / 2, (frame.GetHeight() - 1 - dmpClock.GetHeight())/2, 0, true};
     }
   }
 
-  // Update the DMD
-  dmd.SetFrame(frame);
+  // If debug on, display the refresh isr profile in the bottom left
+  if(cfgItems.cfgDebug != 0)
+  {
+    DmdStats stats ;
+    uint32_t cyclesMax = 0;
+    char textStats[40 + 1];
+
+    // Refresh rate, worst isr duration, overruns and isr load over the last second
+    dmd.GetStats(stats);
+    for(int plane = 0; plane < stats.cntPlanes; plane++)
+    {
+      cyclesMax = max(cyclesMax, stats.planes[plane].cyclesMax);
+    }
+
+    sprintf(textStats, "%luHZ %luUS %luOV %lu%%", stats.hzRefresh, cyclesMax / (F_CPU / 1000000), stats.cntOverruns, stats.dutyIsr);
+    fontSystem.DmpFromString(dmpStats, textStats);
+    layers[cntLayers++] = {&dmpStats, 0, frame.GetHeight() - dmpStats.GetHeight(), 3, false};
+  }
+
+  // What is on show, the clock, second beat, scene frame if any and, once a second, the debug text
+  sprintf(showing, "%s|%s|%lu|%lu", clock, blanking, isSceneShown ? (unsigned long)cntSceneFrames : 0,
+    cfgItems.cfgDebug != 0 ? millisNow / 1000 : 0);
+  if(isInit)
+  {
+    // Back from a screen of its own, whatever it left on show
+    shown[0] = '\0';
+  }
+
+  // Draw and present only a change, one the queue had no room for is tried again next time
+  if(strcmp(showing, shown) != 0)
+  {
+    // Draw the layers over a blank frame, a row at a time
+    frame.Composite(layers, cntLayers);
+
+    // Update the DMD
+    if(dmd.PresentAt(micros() + (millisDue - millisNow) * 1000))
+    {
+      strcpy(shown, showing);
+    }
+  }
+
+  // Pace the rendering to the DMD refresh
+  dmd.WaitRefresh(microsRefreshTimeout);
 }
 
 //-----------------
@@ -722,13 +762,13 @@ void InitDmdType()
 //----------------------
 void DisplayTest()
 {
-  DmdFrame frame ;
-    
   if(btnEnter.ReadRaw() == Button::On)
   {
+    DmdFrame& frame = dmd.AcquireBackBuffer();
+
     // Show test image - all dots on
     frame.Clear(0x0F);
-    dmd.SetFrame(frame);
+    dmd.Present();
 
     // Wait for button to be released
     while(btnEnter.ReadRaw() == Button::On);
@@ -743,7 +783,7 @@ void DisplayTest()
 //-------------------------
 void ShowBootScreen()
 {
-  DmdFrame frame;
+  DmdFrame& frame = dmd.AcquireBackBuffer();
   Dotmap dmpBootMsg;
   char bootMsg[16 + 1];
   
@@ -757,17 +797,20 @@ void ShowBootScreen()
   const char *uController = "N/A";
 #endif
 
+  // Draw from a blank frame
+  frame.Clear();
+
   // Show the version number of the firmware
   sprintf(bootMsg, "DOTCLK V%s", VERSION);
   fontSystem.DmpFromString(dmpBootMsg, bootMsg);
-  frame.DotBlt(dmpBootMsg, 0, 0, dmpBootMsg.GetWidth(), dmpBootMsg.GetHeight(), (128 - dmpBootMsg.GetWidth())/2, (16 - dmpBootMsg.GetHeight()) - 1);
+  frame.DotBlt(dmpBootMsg, 0, 0, dmpBootMsg.GetWidth(), dmpBootMsg.GetHeight(), (frame.GetWidth() - dmpBootMsg.GetWidth())/2, (frame.GetHeight() / 2 - dmpBootMsg.GetHeight()) - 1);
 
   // Show the dmd and uController type
   ConfigItems cfgItems = config.GetCfgItems();
   sprintf(bootMsg, "DMD:%d  uC:%s", cfgItems.cfgDmdType, uController);
   fontSystem.DmpFromString(dmpBootMsg, bootMsg);
-  frame.DotBlt(dmpBootMsg, 0, 0, dmpBootMsg.GetWidth(), dmpBootMsg.GetHeight(), (128 - dmpBootMsg.GetWidth())/2, 16 + 1);
+  frame.DotBlt(dmpBootMsg, 0, 0, dmpBootMsg.GetWidth(), dmpBootMsg.GetHeight(), (frame.GetWidth() - dmpBootMsg.GetWidth())/2, frame.GetHeight() / 2 + 1);
 
   // Update the DMD
-  dmd.SetFrame(frame);
+  dmd.Present();
 }
@@ -17,6 +17,7 @@ Dotmap::Dotmap()
 
   width = 0;
   height = 0;
+  bpp = BppMono;
   widthBytesDots = 0;
   widthBytesMask = 0;
 }
@@ -34,7 +35,7 @@ Dotmap::~Dotmap()
 //---------------------
 Dotmap& Dotmap::operator=(const Dotmap& rhs)
 {
-  Create(rhs.width, rhs.height);
+  Create(rhs.width, rhs.height, rhs.bpp);
   
   if(rhs.dots == NULL)
   {
@@ -62,17 +63,25 @@ Dotmap& Dotmap::operator=(const Dotmap& rhs)
 //-----------------
 // Function: Create
 //-----------------
-void Dotmap::Create(int width, int height)
+void Dotmap::Create(int width, int height, int bpp)
 {
   // Ensure any previous data has been freed
   Delete();
   
-  // Determine byte widths of the dot and mask arrays
-  widthBytesDots = (width / 2) + (width % 2 ? 1 : 0);
+  // Determine byte widths of the dot and mask arrays, colour dots take a word each
+  if(bpp == BppRgb)
+  {
+    widthBytesDots = width * sizeof(uint16_t);
+  }
+  else
+  {
+    widthBytesDots = (width / 2) + (width % 2 ? 1 : 0);
+  }
   widthBytesMask = (width / 8) + (width % 8 ? 1 : 0);
 
   this->width = width;
   this->height = height;
+  this->bpp = (bpp == BppRgb ? BppRgb : BppMono);
 
   // Allocate memory for the arrays
   dots = new byte[widthBytesDots * height];
@@ -102,7 +111,7 @@ bool Dotmap::Create(FsFile& fileDotmap)
   // Only open if we successfully read the dotmap header
   if(ret)
   {
-    Create(dotsWidth, dotsHeight);
+    Create(dotsWidth, dotsHeight, dotsBpp);
     
     // Read the dots data
     ret &= fileDotmap.read(dots, widthBytesDots * height * sizeof(byte)) > -1;
@@ -171,6 +180,14 @@ void Dotmap::SetDot(int x, int y, byte dotSet)
     return;
   }
 
+  // Colour dot, the level goes to every channel
+  if(bpp == BppRgb)
+  {
+    dotSet &= 0x0F;
+    SetDotRgb(x, y, (dotSet << 8) | (dotSet << 4) | dotSet);
+    return;
+  }
+
   // Determine byte offset into bitmap
   idxOffset = (x / 2) + (y * widthBytesDots);
 
@@ -203,6 +220,14 @@ byte Dotmap::GetDot(int x, int y)
   int   idxOffset ;
   byte  get ;
 
+  // Colour dot, the level is that of the brightest channel
+  if(bpp == BppRgb)
+  {
+    uint16_t rgb = GetDotRgb(x, y);
+
+    return max(max((rgb >> 8) & 0x0F, (rgb >> 4) & 0x0F), rgb & 0x0F);
+  }
+
   // Determine byte offset into bitmap
   idxOffset = (x / 2) + (y * widthBytesDots);
 
@@ -224,6 +249,54 @@ byte Dotmap::GetDot(int x, int y)
   return get;
 }
 
+//--------------------
+// Function: SetDotRgb
+//--------------------
+void Dotmap::SetDotRgb(int x, int y, uint16_t rgb)
+{
+  int   idxOffset ;
+
+  if(!CheckRange(x, y))
+  {
+    // Out of range, return
+    return;
+  }
+
+  // Mono dot, the level is that of the brightest channel
+  if(bpp != BppRgb)
+  {
+    SetDot(x, y, max(max((rgb >> 8) & 0x0F, (rgb >> 4) & 0x0F), rgb & 0x0F));
+    return;
+  }
+
+  // Determine byte offset into bitmap, words are little endian as in the file
+  idxOffset = (x * 2) + (y * widthBytesDots);
+
+  dots[idxOffset] = rgb & 0xFF;
+  dots[idxOffset + 1] = (rgb >> 8) & 0x0F;
+}
+
+//--------------------
+// Function: GetDotRgb
+//--------------------
+uint16_t Dotmap::GetDotRgb(int x, int y)
+{
+  int   idxOffset ;
+
+  // Mono dot, the level goes to every channel
+  if(bpp != BppRgb)
+  {
+    uint16_t get = GetDot(x, y);
+
+    return (get << 8) | (get << 4) | get;
+  }
+
+  // Determine byte offset into bitmap, words are little endian as in the file
+  idxOffset = (x * 2) + (y * widthBytesDots);
+
+  return dots[idxOffset] | ((dots[idxOffset + 1] & 0x0F) << 8);
+}
+
 //------------------
 // Function: SetMask
 //------------------
@@ -302,11 +375,39 @@ int Dotmap::GetHeight()
   return height;
 }
 
+//-----------------
+// Function: GetBpp
+//-----------------
+int Dotmap::GetBpp()
+{
+  return bpp;
+}
+
 //---------------
 // Function: Fill
 //---------------
 void Dotmap::Fill(byte dot)
 {
+  if(bpp == BppRgb)
+  {
+    // Colour dots, the level goes to every channel, two little endian words at a time
+    uint32_t rgb = ((dot & 0x0F) << 8) | ((dot & 0x0F) << 4) | (dot & 0x0F);
+    uint32_t pair = rgb | (rgb << 16);
+    int len = widthBytesDots * height * sizeof(byte);
+    int idxOffset;
+
+    for(idxOffset = 0; idxOffset + (int)sizeof(pair) <= len; idxOffset += sizeof(pair))
+    {
+      memcpy(&dots[idxOffset], &pair, sizeof(pair));
+    }
+    if(idxOffset < len)
+    {
+      dots[idxOffset] = rgb & 0xFF;
+      dots[idxOffset + 1] = rgb >> 8;
+    }
+    return;
+  }
+
   memset(dots, (dot & 0x0F) | (dot << 4), widthBytesDots * height * sizeof(byte));
 }
 
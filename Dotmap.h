@@ -3,6 +3,8 @@
 
 #include <SdFat.h>
 
+template<int width, int height, int scan, int channels> class DmdPanelFrame;
+
 class Dotmap
 {
   private:
@@ -11,18 +13,26 @@ class Dotmap
 
     uint16_t width;
     uint16_t height;
+    uint16_t bpp;
     uint16_t widthBytesDots;
     uint16_t widthBytesMask;
 
     bool CheckRange(int x, int y);
     void Delete();
     
+  public:
+    // Dot formats, a 4 bit level or a 16 bit 0x0RGB word of 4 bit channel levels
+    enum {
+      BppMono = 4,
+      BppRgb = 12,
+    };
+
   public:
     Dotmap();
     ~Dotmap();
 
     Dotmap& operator=(const Dotmap& other);
-    void Create(const int width, const int height);
+    void Create(const int width, const int height, const int bpp = BppMono);
     bool Create(FsFile& fileDotmap);
 
     bool SetDotsFromRaw(const byte *data, uint16_t len);
@@ -30,16 +40,22 @@ class Dotmap
 
     void SetDot(int x, int y, byte dot);
     byte GetDot(int x, int y);
+    void SetDotRgb(int x, int y, uint16_t rgb);
+    uint16_t GetDotRgb(int x, int y);
     void SetMask(int x, int y, byte mask);
     byte GetMask(int x, int y);
     int GetWidth();
     int GetHeight();
+    int GetBpp();
 
     void Fill(byte dot);
     void Fill(int x, int y, int width, int height, byte dot);
 
     void ClearDots();
     void ClearMask();
+
+    // Frames blit straight from the dot and mask rows
+    template<int width, int height, int scan, int channels> friend class DmdPanelFrame;
 };
 
 #endif
@@ -3,7 +3,7 @@
 #include "Globals.h"
 
 // Dmd Screen
-Dmd dmd ;
+Dmd<DmdPinout> dmd ;
 
 // Colour Control
 ColourControl colourControl;
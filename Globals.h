@@ -12,14 +12,26 @@
 #include "Config.h"
 #include "Button.h"
 
+// Screen pinout
+#ifdef HUB08
+typedef Hub08Pinout DmdPinout;
+#endif
+
+#ifdef HUB75
+typedef Hub75Pinout DmdPinout;
+#endif
+
 // Constants
 const int pinBtnPlus = 28;
 const int pinBtnMinus = 29;
 const int pinBtnEnter = 27;
 const int pinBtnMenu = 30;
 
+// DMD refresh rate the plane timings are calibrated for
+const int hzDmdRefresh = 400;
+
 // Dmd Screen
-extern Dmd dmd ;
+extern Dmd<DmdPinout> dmd ;
 
 // Colour Control
 extern ColourControl colourControl;
@@ -0,0 +1,73 @@
+#ifndef __PINOUT_H__
+#define __PINOUT_H__
+
+// Dmd pin write primitive
+// A host build can define this before inclusion to count the writes per row
+#ifndef DMD_PIN_WRITE
+#define DMD_PIN_WRITE(pin, value) digitalWriteFast(pin, value)
+#endif
+
+// Dmd port register store primitive, the scanout's port words go out through it
+// A host build can define this before inclusion to replay the words against a panel model
+#ifndef DMD_PORT_WRITE
+#define DMD_PORT_WRITE(reg, value) (*(reg) = (value))
+#endif
+
+// Pin Assignments
+// HUB08
+struct Hub08Pinout
+{
+  static const bool hasBlue = false;
+
+  static const int pinEN = 19 ; // B2
+  static const int pinR1 = 20 ; // D5
+  static const int pinR2 = 21 ; // D6
+  static const int pinG1 = 17 ; // B1
+  static const int pinG2 = 18 ; // B3
+  static const int pinB1 = 22 ;
+  static const int pinB2 = 23 ;
+  static const int pinLA = 7 ;  // D2
+  static const int pinLB = 6 ;  // D4
+  static const int pinLC = 5 ;  // D7
+  static const int pinLD = 4 ;  // A13
+  static const int pinLT = 1 ;  // B17
+  static const int pinSK = 0 ;  // B16
+
+  // Second chain
+  static const int pinR3 = 8 ;
+  static const int pinR4 = 9 ;
+  static const int pinG3 = 10 ;
+  static const int pinG4 = 11 ;
+  static const int pinB3 = 12 ;
+  static const int pinB4 = 14 ;
+};
+
+// HUB75
+struct Hub75Pinout
+{
+  static const bool hasBlue = true;
+
+  static const int pinEN = 23; // A9
+  static const int pinR1 = 16; // A2
+  static const int pinR2 = 18; // A4
+  static const int pinG1 = 17;  // A3
+  static const int pinG2 = 19;  // A5
+  static const int pinB1 = 7;  // 
+  static const int pinB2 = 5;  // 
+  static const int pinLA = 20;  // A6
+  static const int pinLB = 3;  // 
+  static const int pinLC = 21;  // A7 
+  static const int pinLD = 2;  // 
+  static const int pinLT = 1;  // 
+  static const int pinSK = 22;  // A8
+
+  // Second chain
+  static const int pinR3 = 8;  // 
+  static const int pinR4 = 9;  // 
+  static const int pinG3 = 10;  // 
+  static const int pinG4 = 11;  // 
+  static const int pinB3 = 12;  // 
+  static const int pinB4 = 14;  // 
+};
+
+#endif
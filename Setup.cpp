@@ -27,6 +27,8 @@ static void PaintTitle(DmdFrame& frame, const char *titleText);
 static void PaintButtons(DmdFrame& frame, const char *btnText[4]);
 static int HandleStandard(DmdFrame& frame, Menu& menu, bool isInit, int& initValue, FEEDBACK feedback = NULL);
 static void FeedbackDotColour(int value);
+static void FeedbackGamma(int value);
+static void FeedbackPlanes(int value);
 static bool HandleBrightness(DmdFrame& frame, bool isInit, int& initValue);
 static int HandleSetTime(DmdFrame& frame, const char *title, bool tick, bool isInit, time_t& initValue);
 static int HandleTimeCorrect(DmdFrame& frame, bool tick, bool isInit, int& initValue);
@@ -44,6 +46,8 @@ enum
   MENU_CLOCKDELAY,
   MENU_CLOCKFONT,
   MENU_DOTCOLOUR,
+  MENU_GAMMA,
+  MENU_PLANES,
   MENU_BTNMAP,
   MENU_SHOWBRAND,
   MENU_DEBUG,
@@ -52,7 +56,7 @@ enum
 // Standard menu structs
 struct MenuMainMenu : Menu
 {
-  MenuMainMenu() : Menu(13)
+  MenuMainMenu() : Menu(15)
   {
     menuTitle = "MAIN MENU";
     menuItems[0] = "SET TIME";
@@ -65,9 +69,11 @@ struct MenuMainMenu : Menu
     menuItems[7] = "CLOCK DELAY";
     menuItems[8] = "CLOCK FONT";
     menuItems[9] = "DOT COLOUR";
-    menuItems[10] = "BUTTON MAPPING";
-    menuItems[11] = "SHOW BRAND";
-    menuItems[12] = "DEBUG";
+    menuItems[10] = "GAMMA";
+    menuItems[11] = "PLANES";
+    menuItems[12] = "BUTTON MAPPING";
+    menuItems[13] = "SHOW BRAND";
+    menuItems[14] = "DEBUG";
     menuButtons[0] = "Exit";
     menuButtons[1] = "Prev";
     menuButtons[2] = "Next";
@@ -140,7 +146,7 @@ struct MenuDotColour : Menu
   #endif
 
   #ifdef HUB75
-  MenuDotColour() : Menu(8) 
+  MenuDotColour() : Menu(10) 
   {
     menuTitle = "DOT COLOUR";
     menuItems[0] = "RED";
@@ -151,6 +157,8 @@ struct MenuDotColour : Menu
     menuItems[5] = "CYAN";
     menuItems[6] = "WHITE";
     menuItems[7] = "CHANGE";
+    menuItems[8] = "RAINBOW";
+    menuItems[9] = "GRADIENT";
     menuButtons[0] = "Back";
     menuButtons[1] = "Prev";
     menuButtons[2] = "Next";
@@ -159,6 +167,37 @@ struct MenuDotColour : Menu
   #endif
 };
 
+struct MenuGamma : Menu
+{
+  MenuGamma() : Menu(4) 
+  {
+    menuTitle = "GAMMA";
+    menuItems[0] = "LINEAR";
+    menuItems[1] = "1.8";
+    menuItems[2] = "2.2";
+    menuItems[3] = "2.8";
+    menuButtons[0] = "Back";
+    menuButtons[1] = "Prev";
+    menuButtons[2] = "Next";
+    menuButtons[3] = "Save";
+  }
+};
+
+struct MenuPlanes : Menu
+{
+  MenuPlanes() : Menu(3) 
+  {
+    menuTitle = "PLANES";
+    menuItems[0] = "4";
+    menuItems[1] = "5";
+    menuItems[2] = "6";
+    menuButtons[0] = "Back";
+    menuButtons[1] = "Prev";
+    menuButtons[2] = "Next";
+    menuButtons[3] = "Save";
+  }
+};
+
 struct MenuBtnMap : Menu
 {
   MenuBtnMap() : Menu(2) 
@@ -211,6 +250,8 @@ MenuMainMenu menuMainMenu;
   MenuClockDelay menuClockDelay;
   Menu *menuClockFont = NULL;
   MenuDotColour menuDotColour;
+  MenuGamma menuGamma;
+  MenuPlanes menuPlanes;
   MenuBtnMap menuBtnMap;
   MenuShowBrand menuShowBrand;
   MenuDebug menuDebug;
@@ -231,9 +272,12 @@ bool doSetup(bool isInit)
   static bool initMainMenu;
   static int idxSubMenu;
 
-  DmdFrame frame ;
+  DmdFrame& frame = dmd.AcquireBackBuffer();
   bool ret = true;  
 
+  // Draw from a blank frame
+  frame.Clear();
+
   // First time in, initialise
   if(isInit)
   {
@@ -384,6 +428,14 @@ bool doSetup(bool isInit)
             HandleStandard(frame, menuDotColour, true, setItems.cfgDotColour);
             break ;
 
+          case MENU_GAMMA: // Gamma
+            HandleStandard(frame, menuGamma, true, setItems.cfgGamma);
+            break ;
+
+          case MENU_PLANES: // Planes
+            HandleStandard(frame, menuPlanes, true, setItems.cfgPlanes);
+            break ;
+
           case MENU_BTNMAP: // Button Mapping
             HandleStandard(frame, menuBtnMap, true, setItems.cfgBtnMap);
             break ;
@@ -563,6 +615,49 @@ bool doSetup(bool isInit)
         break;
       }
       
+      case MENU_GAMMA: // Gamma
+      {        
+        int menuRet = HandleStandard(frame, menuGamma, false, setItems.cfgGamma, FeedbackGamma);
+        if( menuRet != 0)
+        {
+          if(menuRet == 1)
+          {
+            config.SetCfgItems(setItems);
+          }
+          else
+          {
+            // Reset gamma back on 'Back' button
+            FeedbackGamma(setItems.cfgGamma);
+          }
+          
+          showMainMenu = true;
+        }
+        break;
+      }
+      
+      case MENU_PLANES: // Planes
+      {        
+        int menuRet = HandleStandard(frame, menuPlanes, false, setItems.cfgPlanes, FeedbackPlanes);
+        if( menuRet != 0)
+        {
+          if(menuRet == 1)
+          {
+            config.SetCfgItems(setItems);
+          }
+          else
+          {
+            // Reset planes back on 'Back' button
+            FeedbackPlanes(setItems.cfgPlanes);
+          }
+
+          // Plane count may have changed, so recalibrate the timings, once on leaving rather than for each preview
+          dmd.Calibrate(hzDmdRefresh);
+          
+          showMainMenu = true;
+        }
+        break;
+      }
+      
       case MENU_BTNMAP: // Button Mapping
       {
         int menuRet = HandleStandard(frame, menuBtnMap, false, setItems.cfgBtnMap);
@@ -613,7 +708,7 @@ bool doSetup(bool isInit)
   }
   
   // Update the DMD
-  dmd.SetFrame(frame);
+  dmd.Present();
 
   return ret;
 }
@@ -628,7 +723,7 @@ static void PaintTitle(DmdFrame& frame, const char *titleText)
   time_t time = NowDST();
   
   // Title Text
-  dmpTitle.Create(128, 9);
+  dmpTitle.Create(frame.GetWidth(), 9);
   dmpTitle.Fill(0x01);
   frame.DotBlt(dmpTitle, 0, 0, dmpTitle.GetWidth(), dmpTitle.GetHeight(), 0, 0);
   fontSystem.DmpFromString(dmpTitle, titleText);
@@ -636,7 +731,7 @@ static void PaintTitle(DmdFrame& frame, const char *titleText)
   // Clock
   sprintf(clock, "%02d:%02d", hour(time), minute(time));
   fontSystem.DmpFromString(dmpTitle, clock);
-  frame.DotBlt(dmpTitle, 0, 0, dmpTitle.GetWidth(), dmpTitle.GetHeight(), 128 - dmpTitle.GetWidth(), 1);  
+  frame.DotBlt(dmpTitle, 0, 0, dmpTitle.GetWidth(), dmpTitle.GetHeight(), frame.GetWidth() - dmpTitle.GetWidth(), 1);  
 }
 
 //-----------------------
@@ -645,24 +740,22 @@ static void PaintTitle(DmdFrame& frame, const char *titleText)
 static void PaintButtons(DmdFrame& frame, const char *btnText[4])
 {
   Dotmap dmpButtons;
+  int widthSlot = frame.GetWidth() / 4;
 
-  // Background
+  // Background, a button centred in each quarter of the width
   dmpButtons.Create(28, 9);
   dmpButtons.Fill(0x01);
-  frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), 2, 23);
-  frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), 34, 23);
-  frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), 66, 23);
-  frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), 98, 23);
+  for(int btn = 0; btn < 4; btn++)
+  {
+    frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), (btn * widthSlot) + ((widthSlot - 28) / 2), 23);
+  }
   
   // Button Text
-  fontSystem.DmpFromString(dmpButtons, btnText[0]);
-  frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), 2 + ((28 - dmpButtons.GetWidth()) / 2), 24);
-  fontSystem.DmpFromString(dmpButtons, btnText[1]);
-  frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), 34 + ((28 - dmpButtons.GetWidth()) / 2), 24);
-  fontSystem.DmpFromString(dmpButtons, btnText[2]);
-  frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), 66 + ((28 - dmpButtons.GetWidth()) / 2), 24);
-  fontSystem.DmpFromString(dmpButtons, btnText[3]);
-  frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), 98 + ((28 - dmpButtons.GetWidth()) / 2), 24);
+  for(int btn = 0; btn < 4; btn++)
+  {
+    fontSystem.DmpFromString(dmpButtons, btnText[btn]);
+    frame.DotBlt(dmpButtons, 0, 0, dmpButtons.GetWidth(), dmpButtons.GetHeight(), (btn * widthSlot) + ((widthSlot - dmpButtons.GetWidth()) / 2), 24);
+  }
 }
 
 //-------------------------
@@ -737,12 +830,12 @@ static int HandleStandard(DmdFrame& frame, Menu& menu, bool isInit, int& initVal
   if(value < (menu.cntMenuItems - 1))
   {
     fontMenu.DmpFromString(dmpSetup, ">");
-    frame.DotBlt(dmpSetup, 0, 0, dmpSetup.GetWidth(), dmpSetup.GetHeight(), 128 - dmpSetup.GetWidth(), 11);
+    frame.DotBlt(dmpSetup, 0, 0, dmpSetup.GetWidth(), dmpSetup.GetHeight(), frame.GetWidth() - dmpSetup.GetWidth(), 11);
   }
   
   // Menu Item
   fontMenu.DmpFromString(dmpSetup, menu.menuItems[value]);
-  frame.DotBlt(dmpSetup, 0, 0, dmpSetup.GetWidth(), dmpSetup.GetHeight(), (128 - dmpSetup.GetWidth()) / 2, 11);
+  frame.DotBlt(dmpSetup, 0, 0, dmpSetup.GetWidth(), dmpSetup.GetHeight(), (frame.GetWidth() - dmpSetup.GetWidth()) / 2, 11);
 
   // Buttons
   PaintButtons(frame, menu.menuButtons);
@@ -758,6 +851,22 @@ static void FeedbackDotColour(int value)
   colourControl.SetColour(value);  
 }
 
+//------------------------
+// Function: FeedbackGamma
+//------------------------
+static void FeedbackGamma(int value)
+{
+  SetDmdGamma(value);
+}
+
+//-------------------------
+// Function: FeedbackPlanes
+//-------------------------
+static void FeedbackPlanes(int value)
+{
+  SetDmdPlanes(value);
+}
+
 //---------------------------
 // Function: HandleBrightness
 //---------------------------
@@ -766,6 +875,7 @@ static bool HandleBrightness(DmdFrame& frame, bool isInit, int& initValue)
   static int value ;
   bool ret = true;
   Dotmap dmpBrightness ;
+  int xBar;
   const char *btnText[] = {"Back", "Down", "Up", "Save", };
   
   int btnMenuRead = btnMenu.Read();
@@ -815,18 +925,19 @@ static bool HandleBrightness(DmdFrame& frame, bool isInit, int& initValue)
   // Title
   PaintTitle(frame, "BRIGHTNESS");
 
-  // Brightness Bar Graph
+  // Brightness Bar Graph, centred
+  xBar = (frame.GetWidth() - 68) / 2;
   dmpBrightness.Create(68, 8);
   dmpBrightness.Fill(5);
-  frame.DotBlt(dmpBrightness, 0, 0, dmpBrightness.GetWidth(), dmpBrightness.GetHeight(), 30, 12);
+  frame.DotBlt(dmpBrightness, 0, 0, dmpBrightness.GetWidth(), dmpBrightness.GetHeight(), xBar, 12);
 
   dmpBrightness.Create(66, 6);
   dmpBrightness.Fill(0);
-  frame.DotBlt(dmpBrightness, 0, 0, dmpBrightness.GetWidth(), dmpBrightness.GetHeight(), 31, 13);
+  frame.DotBlt(dmpBrightness, 0, 0, dmpBrightness.GetWidth(), dmpBrightness.GetHeight(), xBar + 1, 13);
 
   dmpBrightness.Create(64, 4);
   dmpBrightness.Fill(15);
-  frame.DotBlt(dmpBrightness, 0, 0, (dmpBrightness.GetWidth()/64)*(value + 1), dmpBrightness.GetHeight(), 32, 14);
+  frame.DotBlt(dmpBrightness, 0, 0, (dmpBrightness.GetWidth()/64)*(value + 1), dmpBrightness.GetHeight(), xBar + 2, 14);
 
   // Buttons
   PaintButtons(frame, btnText);
@@ -922,7 +1033,7 @@ static int HandleSetTime(DmdFrame& frame, const char *title, bool tick, bool isI
   
   sprintf(setTimeStr, ">%02d:%02d<", value.Hour, value.Minute);
   fontMenu.DmpFromString(dmpSetTime, setTimeStr, position == 0 ? blankingPos0 : blankingPos1);
-  frame.DotBlt(dmpSetTime, 0, 0, dmpSetTime.GetWidth(), dmpSetTime.GetHeight(), (128 - dmpSetTime.GetWidth()) / 2, 11);
+  frame.DotBlt(dmpSetTime, 0, 0, dmpSetTime.GetWidth(), dmpSetTime.GetHeight(), (frame.GetWidth() - dmpSetTime.GetWidth()) / 2, 11);
 
   // Buttons
   btnText[3] = (position == 0 ? "Next" : "Save");
@@ -996,7 +1107,7 @@ static int HandleTimeCorrect(DmdFrame& frame, bool tick, bool isInit, int& initV
   sprintf(setStr, "> %+04d <", value);
 
   fontMenu.DmpFromString(dmpSet, setStr, blanking);
-  frame.DotBlt(dmpSet, 0, 0, dmpSet.GetWidth(), dmpSet.GetHeight(), (128 - dmpSet.GetWidth()) / 2, 11);
+  frame.DotBlt(dmpSet, 0, 0, dmpSet.GetWidth(), dmpSet.GetHeight(), (frame.GetWidth() - dmpSet.GetWidth()) / 2, 11);
 
   // Buttons
   PaintButtons(frame, btnText);
@@ -26,6 +26,58 @@ void SetBtnMapping(bool reverse)
   }
 }
 
+//----------------------
+// Function: SetDmdGamma
+//----------------------
+void SetDmdGamma(int gamma)
+{
+  float gammaDmd;
+
+  switch(gamma)
+  {
+    default:
+    case Config::CFG_GM_LINEAR:
+      gammaDmd = 1.0;
+      break;
+    case Config::CFG_GM_18:
+      gammaDmd = 1.8;
+      break;
+    case Config::CFG_GM_22:
+      gammaDmd = 2.2;
+      break;
+    case Config::CFG_GM_28:
+      gammaDmd = 2.8;
+      break;
+  }
+
+  dmd.SetGamma(gammaDmd);
+}
+
+//-----------------------
+// Function: SetDmdPlanes
+//-----------------------
+void SetDmdPlanes(int planes)
+{
+  int cntPlanes;
+
+  switch(planes)
+  {
+    default:
+    case Config::CFG_PL_4:
+      cntPlanes = 4;
+      break;
+    case Config::CFG_PL_5:
+      cntPlanes = 5;
+      break;
+    case Config::CFG_PL_6:
+      cntPlanes = 6;
+      break;
+  }
+
+  // Timings follow, the refresh kept at the rate last calibrated for
+  dmd.SetPlanes(cntPlanes);
+}
+
 //-----------------
 // Function: nowDST
 //-----------------
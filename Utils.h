@@ -4,6 +4,8 @@
 extern "C" {
 
   void SetBtnMapping(bool reverse);
+  void SetDmdGamma(int gamma);
+  void SetDmdPlanes(int planes);
   time_t NowDST();
   void CpuRestart();
   time_t getTeensy3Time();
@@ -0,0 +1,603 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "Host.h"
+
+// Driver under test
+Dmd<DmdPinout> dmd;
+
+HostConfig hostConfig = { 2, 2, true };
+HostCounts hostCounts;
+HostPanel hostPanel;
+
+uint32_t hostDemcr;
+uint32_t hostDwtCtrl;
+
+// Fake clock, the priority of the isr running, main is below every timer
+static std::atomic<uint64_t> cyclesNow(0);
+static int levelRunning = 256;
+
+// Interrupts off is a lock the isr of a threaded test holds too
+static std::recursive_mutex mutexIrq;
+static thread_local int depthIrq = 0;
+
+// Ports, eight pins each
+struct HostPort
+{
+  volatile uint32_t regSet;
+  volatile uint32_t regClear;
+};
+
+static HostPort ports[8];
+static int failures = 0;
+
+//-----------------
+// Function: timers
+//-----------------
+static std::vector<IntervalTimer *>& timers()
+{
+  static std::vector<IntervalTimer *> list;
+
+  return list;
+}
+
+//----------------------
+// Function: Constructor
+//----------------------
+IntervalTimer::IntervalTimer()
+{
+  funct = NULL;
+  isActive = false;
+  level = 128;
+  cyclesDue = 0;
+  cyclesReload = 0;
+  cntBegins = 0;
+  cntUpdates = 0;
+  cntEnds = 0;
+  cntFires = 0;
+  cntIrqOffCalls = 0;
+  timers().push_back(this);
+}
+
+//---------------------
+// Function: Destructor
+//---------------------
+IntervalTimer::~IntervalTimer()
+{
+  for(size_t idx = 0; idx < timers().size(); idx++)
+  {
+    if(timers()[idx] == this)
+    {
+      timers().erase(timers().begin() + idx);
+      break;
+    }
+  }
+}
+
+//----------------
+// Function: Begin
+//----------------
+bool IntervalTimer::Begin(void (*set)(), double microseconds)
+{
+  cntBegins++;
+  cntIrqOffCalls += (depthIrq > 0);
+
+  // Too short for the PIT
+  if(microseconds < microsMin)
+  {
+    return false;
+  }
+
+  funct = set;
+  cyclesReload = (uint64_t)(microseconds * HostCyclesMicro + 0.5);
+  cyclesDue = hostCycles() + cyclesReload;
+  isActive = true;
+
+  return true;
+}
+
+//-----------------
+// Function: Update
+//-----------------
+void IntervalTimer::Update(double microseconds)
+{
+  // Taken as the reload after the period running
+  cntUpdates++;
+  cyclesReload = (uint64_t)(microseconds * HostCyclesMicro + 0.5);
+}
+
+//--------------
+// Function: end
+//--------------
+void IntervalTimer::end()
+{
+  cntEnds++;
+  cntIrqOffCalls += (depthIrq > 0);
+  isActive = false;
+}
+
+//-------------------
+// Function: priority
+//-------------------
+void IntervalTimer::priority(uint8_t set)
+{
+  level = set;
+}
+
+//---------------------
+// Function: hostCycles
+//---------------------
+uint64_t hostCycles()
+{
+  return cyclesNow.load();
+}
+
+//----------------------
+// Function: hostAdvance
+//----------------------
+void hostAdvance(uint64_t cycles)
+{
+  uint64_t cyclesTarget = cyclesNow.load() + cycles;
+
+  // Every timer of a higher priority than the code running that falls due on the way fires, earliest first
+  while(hostConfig.isScheduled && depthIrq == 0)
+  {
+    IntervalTimer *timer = NULL;
+
+    for(IntervalTimer *candidate : timers())
+    {
+      if(candidate->isActive && candidate->level < levelRunning && candidate->cyclesDue <= cyclesTarget &&
+        (timer == NULL || candidate->cyclesDue < timer->cyclesDue))
+      {
+        timer = candidate;
+      }
+    }
+
+    if(timer == NULL)
+    {
+      break;
+    }
+
+    // Late when the code running held it off, the PIT reloads as it fires
+    if(timer->cyclesDue > cyclesNow.load())
+    {
+      cyclesNow.store(timer->cyclesDue);
+    }
+    timer->cyclesDue += timer->cyclesReload;
+    timer->cntFires++;
+
+    int levelPrevious = levelRunning;
+    levelRunning = timer->level;
+    timer->funct();
+    levelRunning = levelPrevious;
+
+    // Whatever fell due while it ran is pending too
+    cyclesTarget = max(cyclesTarget, cyclesNow.load());
+  }
+
+  if(cyclesTarget > cyclesNow.load())
+  {
+    cyclesNow.store(cyclesTarget);
+  }
+}
+
+//------------------------
+// Function: hostRunMicros
+//------------------------
+void hostRunMicros(uint32_t micros)
+{
+  for(uint32_t step = 0; step < micros; step++)
+  {
+    hostAdvance(HostCyclesMicro);
+  }
+}
+
+//-------------------------
+// Function: hostRunLatches
+//-------------------------
+bool hostRunLatches(uint32_t cnt, uint32_t microsTimeout)
+{
+  uint32_t cntStart = hostPanel.cntLatches;
+
+  for(uint32_t step = 0; hostPanel.cntLatches - cntStart < cnt; step++)
+  {
+    if(step == microsTimeout)
+    {
+      return false;
+    }
+
+    hostAdvance(HostCyclesMicro);
+  }
+
+  return true;
+}
+
+//--------------------
+// Function: hostTimer
+//--------------------
+IntervalTimer *hostTimer(uint8_t level)
+{
+  for(IntervalTimer *timer : timers())
+  {
+    if(timer->level == level)
+    {
+      return timer;
+    }
+  }
+
+  return NULL;
+}
+
+//----------------------
+// Function: hostPinPort
+//----------------------
+int hostPinPort(uint8_t pin)
+{
+  return pin / 8;
+}
+
+//--------------------
+// Function: hostCheck
+//--------------------
+bool hostCheck(bool ok, const char *text, const char *file, int line)
+{
+  if(!ok)
+  {
+    printf("%s:%d: check failed: %s\n", file, line, text);
+    failures++;
+  }
+
+  return ok;
+}
+
+//---------------------
+// Function: hostReport
+//---------------------
+int hostReport(const char *test)
+{
+  printf("%s: %s, %d failed\n", test, failures == 0 ? "passed" : "FAILED", failures);
+
+  return failures == 0 ? 0 : 1;
+}
+
+//----------------------
+// Function: Constructor
+//----------------------
+HostPanel::HostPanel()
+{
+  Reset();
+}
+
+//----------------
+// Function: Reset
+//----------------
+void HostPanel::Reset()
+{
+  memset(pins, 0, sizeof(pins));
+  memset(shift, 0, sizeof(shift));
+  memset(latched, 0, sizeof(latched));
+  cntShifted = 0;
+  cntPulses = 0;
+  cntLatches = 0;
+  cntGlitches = 0;
+  cntStores = 0;
+  cntSetupViolations = 0;
+  storeClockLow = 0;
+  storeDataFirst = 0;
+  storeDataChanged = 0;
+  isDataPending = false;
+  pulses.clear();
+  rows.clear();
+  isCountingRows = false;
+  latches.clear();
+  isRecordingLatches = false;
+  memset(&countsLatch, 0, sizeof(countsLatch));
+  ClearLit();
+
+  // Every pin LOW, so enabled on row address 0
+  cyclesEnabled = hostCycles();
+  addressEnabled = 0;
+}
+
+//-------------------
+// Function: ClearLit
+//-------------------
+void HostPanel::ClearLit()
+{
+  lit.assign(DmdScan * DmdScanPulses * DmdLanesChain * DmdChains, 0);
+}
+
+//--------------
+// Function: Lit
+//--------------
+uint64_t HostPanel::Lit(int address, int pulse, int lane)
+{
+  return lit[(((address * DmdScanPulses) + pulse) * DmdLanesChain * DmdChains) + lane];
+}
+
+//---------------
+// Function: Read
+//---------------
+byte HostPanel::Read(uint8_t pin)
+{
+  return pins[pin];
+}
+
+//------------------
+// Function: Address
+//------------------
+int HostPanel::Address()
+{
+  return pins[DmdPinout::pinLA] | (pins[DmdPinout::pinLB] << 1) | (pins[DmdPinout::pinLC] << 2) | (pins[DmdPinout::pinLD] << 3);
+}
+
+//----------------
+// Function: Lanes
+//----------------
+DmdLaneCode HostPanel::Lanes()
+{
+  const int pinLanes[12] = { DmdPinout::pinR1, DmdPinout::pinG1, DmdPinout::pinB1, DmdPinout::pinR2, DmdPinout::pinG2, DmdPinout::pinB2,
+                             DmdPinout::pinR3, DmdPinout::pinG3, DmdPinout::pinB3, DmdPinout::pinR4, DmdPinout::pinG4, DmdPinout::pinB4 };
+  DmdLaneCode lanes = 0;
+
+  // A screen without blue lines leaves them unconnected
+  for(int lane = 0; lane < DmdLanesChain * DmdChains; lane++)
+  {
+    if((DmdPinout::hasBlue || (lane % 3) != 2) && pins[pinLanes[lane]])
+    {
+      lanes |= 1 << lane;
+    }
+  }
+
+  return lanes;
+}
+
+//-----------------
+// Function: IsData
+//-----------------
+bool HostPanel::IsData(uint8_t pin)
+{
+  const int pinLanes[12] = { DmdPinout::pinR1, DmdPinout::pinG1, DmdPinout::pinB1, DmdPinout::pinR2, DmdPinout::pinG2, DmdPinout::pinB2,
+                             DmdPinout::pinR3, DmdPinout::pinG3, DmdPinout::pinB3, DmdPinout::pinR4, DmdPinout::pinG4, DmdPinout::pinB4 };
+
+  for(int lane = 0; lane < DmdLanesChain * DmdChains; lane++)
+  {
+    if((DmdPinout::hasBlue || (lane % 3) != 2) && pin == pinLanes[lane])
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//----------------
+// Function: Write
+//----------------
+void HostPanel::Write(uint8_t pin, uint8_t value)
+{
+  byte previous = pins[pin];
+
+  pins[pin] = (value ? HIGH : LOW);
+  if(pins[pin] == previous)
+  {
+    return;
+  }
+
+  if(IsData(pin))
+  {
+    // Data for the next rise, from the first change to the last
+    if(!isDataPending)
+    {
+      storeDataFirst = cntStores;
+      isDataPending = true;
+    }
+    storeDataChanged = cntStores;
+  }
+  else
+  if(pin == DmdPinout::pinSK && pins[pin] == LOW)
+  {
+    storeClockLow = cntStores;
+  }
+  else
+  if(pin == DmdPinout::pinSK && pins[pin] == HIGH)
+  {
+    // Clock rising, the lanes move one pulse along the chain
+    // Data changed with the clock LOW, from the same store at the earliest, and steady for a while before
+    if(isDataPending && (storeDataFirst < storeClockLow || cntStores - storeDataChanged < HostStoresSetup))
+    {
+      cntSetupViolations++;
+    }
+    isDataPending = false;
+
+    shift[cntShifted % DmdScanPulses] = Lanes();
+    cntShifted++;
+    cntPulses++;
+  }
+  else
+  if(pin == DmdPinout::pinLT && pins[pin] == LOW)
+  {
+    // Latch falling, the last row's worth of pulses goes to the row address, the first shifted out the furthest
+    int address = Address();
+
+    for(int pulse = 0; pulse < DmdScanPulses; pulse++)
+    {
+      latched[address][pulse] = shift[(cntShifted + pulse) % DmdScanPulses];
+    }
+    cntLatches++;
+
+    if(isRecordingLatches)
+    {
+      latches.push_back({ address, std::vector<DmdLaneCode>(latched[address], latched[address] + DmdScanPulses) });
+    }
+
+    // Writes since the last latch
+    if(isCountingRows)
+    {
+      HostCounts counts;
+
+      for(int pinCount = 0; pinCount < 64; pinCount++)
+      {
+        counts.pinWrites[pinCount] = hostCounts.pinWrites[pinCount] - countsLatch.pinWrites[pinCount];
+      }
+      counts.cntPinWrites = hostCounts.cntPinWrites - countsLatch.cntPinWrites;
+      counts.cntPortWrites = hostCounts.cntPortWrites - countsLatch.cntPortWrites;
+      rows.push_back(counts);
+    }
+    countsLatch = hostCounts;
+  }
+  else
+  if(pin == DmdPinout::pinEN)
+  {
+    if(pins[pin] == LOW)
+    {
+      // Enabled, the row address lights
+      cyclesEnabled = hostCycles();
+      addressEnabled = Address();
+    }
+    else
+    {
+      // Disabled, every lit lane of the row has been on since
+      uint64_t cycles = hostCycles() - cyclesEnabled;
+
+      for(int pulse = 0; pulse < DmdScanPulses; pulse++)
+      {
+        for(int lane = 0; lane < DmdLanesChain * DmdChains; lane++)
+        {
+          if(latched[addressEnabled][pulse] & (1 << lane))
+          {
+            lit[(((addressEnabled * DmdScanPulses) + pulse) * DmdLanesChain * DmdChains) + lane] += cycles;
+          }
+        }
+      }
+
+      pulses.push_back({ addressEnabled, cycles });
+    }
+  }
+
+  // Nothing may change under a lit row
+  if(pins[DmdPinout::pinEN] == LOW && pin != DmdPinout::pinEN &&
+    (pin == DmdPinout::pinLT || pin == DmdPinout::pinLA || pin == DmdPinout::pinLB || pin == DmdPinout::pinLC || pin == DmdPinout::pinLD))
+  {
+    cntGlitches++;
+  }
+}
+
+// Teensy core stand-ins
+uint32_t hostCycleCount()
+{
+  hostAdvance(1);
+
+  return (uint32_t)hostCycles();
+}
+
+uint32_t micros()
+{
+  hostAdvance(1);
+
+  return (uint32_t)(hostCycles() / HostCyclesMicro);
+}
+
+uint32_t millis()
+{
+  hostAdvance(1);
+
+  return (uint32_t)(hostCycles() / (HostCyclesMicro * 1000));
+}
+
+void delay(uint32_t msec)
+{
+  hostAdvance(msec * HostCyclesMicro * 1000);
+}
+
+void delayMicroseconds(uint32_t usec)
+{
+  hostAdvance(usec * HostCyclesMicro);
+}
+
+void yield()
+{
+  // A threaded test's isr runs by itself
+  if(!hostConfig.isScheduled)
+  {
+    std::this_thread::yield();
+  }
+
+  hostAdvance(HostCyclesMicro);
+}
+
+void noInterrupts()
+{
+  mutexIrq.lock();
+  depthIrq++;
+}
+
+void interrupts()
+{
+  depthIrq--;
+  mutexIrq.unlock();
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  hostPinWrite(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+  return hostPanel.Read(pin);
+}
+
+void hostPinWrite(uint8_t pin, uint8_t value)
+{
+  hostCounts.pinWrites[pin]++;
+  hostCounts.cntPinWrites++;
+  hostPanel.cntStores++;
+  hostPanel.Write(pin, value);
+  hostAdvance(hostConfig.cyclesPinWrite);
+}
+
+volatile uint32_t *portSetRegister(uint8_t pin)
+{
+  return &ports[hostPinPort(pin)].regSet;
+}
+
+volatile uint32_t *portClearRegister(uint8_t pin)
+{
+  return &ports[hostPinPort(pin)].regClear;
+}
+
+uint32_t digitalPinToBitMask(uint8_t pin)
+{
+  return 1 << (pin % 8);
+}
+
+void hostPortWrite(volatile uint32_t *reg, uint32_t value)
+{
+  // Each bit set goes to its pin, HIGH through a set register and LOW through a clear one
+  hostPanel.cntStores++;
+  for(int port = 0; port < 8; port++)
+  {
+    if(reg != &ports[port].regSet && reg != &ports[port].regClear)
+    {
+      continue;
+    }
+
+    for(int bit = 0; bit < 8; bit++)
+    {
+      if(value & (1 << bit))
+      {
+        hostPanel.Write((port * 8) + bit, reg == &ports[port].regSet ? HIGH : LOW);
+      }
+    }
+  }
+
+  *reg = value;
+  hostCounts.cntPortWrites++;
+  hostAdvance(hostConfig.cyclesPortWrite);
+}
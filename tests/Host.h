@@ -0,0 +1,129 @@
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <vector>
+
+#include "Globals.h"
+
+// Host harness for the Dmd driver
+// A fake cycle clock runs the IntervalTimers in priority order as their time comes, pin and port writes are
+// counted, cost a few cycles each and drive a model of the panel
+
+const uint64_t HostCyclesMicro = F_CPU / 1000000;
+
+// Stores a data line must be steady for before the clock rises, as the pin at a time scanout gave it
+const uint32_t HostStoresSetup = 1;
+
+// Harness settings, tests change them before starting the Dmd
+struct HostConfig
+{
+  // Cycles each pin write and each port store takes, the isr's duration follows from them
+  uint32_t cyclesPinWrite;
+  uint32_t cyclesPortWrite;
+
+  // Timers fire off the clock, a threaded test clears it and calls the isr itself
+  bool isScheduled;
+};
+
+// Write counters
+struct HostCounts
+{
+  uint32_t pinWrites[64];
+  uint32_t cntPinWrites;
+  uint32_t cntPortWrites;
+};
+
+// A stretch of time the display was enabled for, and the row address it lit
+struct HostEnablePulse
+{
+  int address;
+  uint64_t cycles;
+};
+
+// A row latched, its address and the lanes of each clock pulse
+struct HostLatch
+{
+  int address;
+  std::vector<DmdLaneCode> lanes;
+};
+
+// Panel on the Dmd pins, data lines are shifted in on a rising clock, latched to the row address on a falling
+// latch, and the latched row is lit while enable is LOW
+class HostPanel
+{
+  private:
+    byte pins[64];
+    DmdLaneCode shift[DmdScanPulses];
+    uint32_t cntShifted;
+    HostCounts countsLatch;
+    uint32_t storeClockLow;
+    uint32_t storeDataFirst;
+    uint32_t storeDataChanged;
+    bool isDataPending;
+    uint64_t cyclesEnabled;
+    int addressEnabled;
+
+    int Address();
+    DmdLaneCode Lanes();
+    bool IsData(uint8_t pin);
+
+  public:
+    HostPanel();
+
+    // Lanes of each clock pulse of each row address as last latched, a bit per data line as DmdLaneR1 on
+    DmdLaneCode latched[DmdScan][DmdScanPulses];
+
+    // Cycles each lane of each clock pulse of each row address has been lit for
+    std::vector<uint64_t> lit;
+
+    // Enable pulses, as they end
+    std::vector<HostEnablePulse> pulses;
+
+    // Writes from one latch to the next, one entry a row while counting
+    std::vector<HostCounts> rows;
+    bool isCountingRows;
+
+    // Rows as they are latched, while recording
+    std::vector<HostLatch> latches;
+    bool isRecordingLatches;
+
+    uint32_t cntPulses;
+    uint32_t cntLatches;
+
+    // Latch or row address changes made while the display was enabled
+    uint32_t cntGlitches;
+
+    // Pin and port stores so far, and clock rises with a data line changed too near before or while the clock
+    // was still HIGH
+    uint32_t cntStores;
+    uint32_t cntSetupViolations;
+
+    void Reset();
+    void ClearLit();
+    uint64_t Lit(int address, int pulse, int lane);
+    void Write(uint8_t pin, uint8_t value);
+    byte Read(uint8_t pin);
+};
+
+extern HostConfig hostConfig;
+extern HostCounts hostCounts;
+extern HostPanel hostPanel;
+
+uint64_t hostCycles();
+void hostAdvance(uint64_t cycles);
+void hostRunMicros(uint32_t micros);
+bool hostRunLatches(uint32_t cnt, uint32_t microsTimeout = 1000000);
+
+// Timer running at a priority, NULL if none is
+IntervalTimer *hostTimer(uint8_t level);
+
+// Port and bit a pin is on, eight pins a port
+int hostPinPort(uint8_t pin);
+
+// Checks, a test's exit code is its failure count
+#define CHECK(cond) hostCheck((cond), #cond, __FILE__, __LINE__)
+
+bool hostCheck(bool ok, const char *text, const char *file, int line);
+int hostReport(const char *test);
+
+#endif
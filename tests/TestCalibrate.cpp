@@ -0,0 +1,103 @@
+#include <algorithm>
+
+#include "Host.h"
+
+// Row scheduling on the fake timer, the refresh timer is reprogrammed a row at a time and never restarted,
+// and calibration against the profile of the row updates, which no plane is then shorter than
+
+const int cntPlanesCalibrate = 6;
+const int hzCalibrate = 200;
+
+// Slack for the isr's own cycles at either end of an on time, and a percent of it for the next latch cutting
+// it short
+const uint64_t cyclesSlack = 12;
+
+int main()
+{
+  IntervalTimer *timerDmd;
+  uint32_t cntBegins, cntUpdates, cntLatches;
+  uint32_t microsCalibrate;
+  DmdStats stats;
+
+  dmd.Initialise();
+  dmd.Start();
+
+  // The refresh timer is the one at the row update's priority
+  timerDmd = hostTimer(200);
+  if(!CHECK(timerDmd != NULL))
+  {
+    return hostReport("TestCalibrate");
+  }
+
+  // Once begun each row only reloads the running timer, the probe reports what that took over a refresh
+  cntBegins = timerDmd->cntBegins;
+  cntUpdates = timerDmd->cntUpdates;
+  cntLatches = hostPanel.cntLatches;
+  CHECK(hostRunLatches(DmdScan * dmd.GetPlanes() * 8));
+  CHECK(timerDmd->cntBegins == cntBegins);
+  CHECK(timerDmd->cntEnds == 0);
+  CHECK(timerDmd->cntUpdates - cntUpdates == hostPanel.cntLatches - cntLatches);
+  CHECK(dmd.GetTimerCycles() > 0);
+
+  // The default shortest planes are shorter than a row update
+  hostRunMicros(1100000);
+  dmd.GetStats(stats);
+  CHECK(stats.cntOverruns > 0);
+
+  // No refresh rate to share out
+  CHECK(!dmd.Calibrate(0));
+  CHECK(!dmd.Calibrate(-hzCalibrate));
+
+  // Calibrated, so short a refresh the shortest plane is held at the row update's time, against a whole
+  // second's profile taken after it was asked for
+  CHECK(dmd.SetPlanes(cntPlanesCalibrate));
+  microsCalibrate = micros();
+  CHECK(dmd.Calibrate(hzCalibrate));
+  CHECK(micros() - microsCalibrate >= 1000000);
+  CHECK(dmd.SetBrightness(63));
+
+  // Timings go with the frames, the next one presented takes them up
+  dmd.AcquireBackBuffer().Clear(0x0F);
+  CHECK(dmd.Present());
+
+  // A whole second's profile taken since, no row outruns its plane and the refresh is as asked for
+  hostRunMicros(2100000);
+  dmd.GetStats(stats);
+  CHECK(stats.cntPlanes == cntPlanesCalibrate);
+  CHECK(stats.cntOverruns == 0);
+  CHECK(stats.hzRefresh >= hzCalibrate * 95 / 100 && stats.hzRefresh <= hzCalibrate * 105 / 100);
+
+  // Held or not, each plane is lit for twice as long as the one before
+  std::vector<uint64_t> measured;
+
+  hostPanel.pulses.clear();
+  CHECK(hostRunLatches((DmdScan * cntPlanesCalibrate) + 1));
+  for(int pulse = 0; pulse < DmdScan * cntPlanesCalibrate && pulse < (int)hostPanel.pulses.size(); pulse++)
+  {
+    measured.push_back(hostPanel.pulses[pulse].cycles);
+  }
+  std::sort(measured.begin(), measured.end());
+
+  if(CHECK(measured.size() == (size_t)(DmdScan * cntPlanesCalibrate)))
+  {
+    for(int plane = 1; plane < cntPlanesCalibrate; plane++)
+    {
+      uint64_t cyclesShorter = measured[(plane - 1) * DmdScan];
+      uint64_t cycles = measured[plane * DmdScan];
+
+      uint64_t cyclesTolerance = cyclesSlack + (cycles / 100);
+
+      if(!CHECK(cycles + cyclesTolerance >= cyclesShorter * 2 && cycles <= (cyclesShorter * 2) + cyclesTolerance))
+      {
+        printf("plane %d lit for %llu cycles, plane %d for %llu\n", plane - 1, (unsigned long long)cyclesShorter, plane, (unsigned long long)cycles);
+      }
+    }
+  }
+
+  // Far too fast a refresh for the row updates
+  CHECK(!dmd.Calibrate(hzCalibrate * 100));
+
+  dmd.Stop();
+
+  return hostReport("TestCalibrate");
+}
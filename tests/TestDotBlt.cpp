@@ -0,0 +1,143 @@
+#include <chrono>
+
+#include "Host.h"
+
+// Blits of the sizes the sketch draws, a scene frame, clocks in the standard and menu fonts and the setup
+// screens' title and buttons, at every alignment and falling off each edge of the frame, checked against a dot
+// at a time reference and timed against it
+
+const int cntTimed = 500;
+
+// Dotmap size and where it lands
+struct BltCase
+{
+  const char *name;
+  int width;
+  int height;
+  int x;
+  int y;
+};
+
+static const BltCase cases[] =
+{
+  { "scene", 128, 32, 0, 0 },
+  { "clock", 65, 21, 31, 5 },
+  { "clock odd", 65, 21, 30, 5 },
+  { "menu clock", 40, 11, 44, 10 },
+  { "menu clock left", 40, 11, -13, 10 },
+  { "menu clock right", 40, 11, DmdWidth - 27, 10 },
+  { "menu clock top", 40, 11, 44, -4 },
+  { "menu clock bottom", 40, 11, 45, DmdHeight - 3 },
+  { "menu clock off", 40, 11, DmdWidth + 5, 10 },
+  { "title", 128, 9, 0, 0 },
+  { "title shadow", 128, 9, 1, 1 },
+  { "button", 28, 9, 2, 23 },
+  { "button odd", 28, 9, 33, 24 },
+};
+
+//------------------------
+// Function: createDotmap
+//------------------------
+static void createDotmap(Dotmap& dmp, int width, int height, uint32_t seed)
+{
+  dmp.Create(width, height);
+
+  // Rows wholly opaque, wholly transparent, and with a dot in four transparent
+  for(int y = 0; y < height; y++)
+  {
+    for(int x = 0; x < width; x++)
+    {
+      seed = (seed * 1103515245) + 12345;
+      dmp.SetDot(x, y, (seed >> 16) & 0x0F);
+      dmp.SetMask(x, y, (y % 3 == 1) || ((y % 3 == 2) && ((seed >> 24) & 0x03) == 0));
+    }
+  }
+}
+
+//------------------------
+// Function: referenceBlt
+//------------------------
+static void referenceBlt(DmdFrame& frame, Dotmap& dmp, int destX, int destY)
+{
+  // A dot at a time through the dotmap's and frame's own accessors, which range check every one, columns
+  // outside as the blit before the row by row one did
+  for(int x = 0; x < dmp.GetWidth(); x++)
+  {
+    for(int y = 0; y < dmp.GetHeight(); y++)
+    {
+      if(!dmp.GetMask(x, y))
+      {
+        frame.SetDot(destX + x, destY + y, dmp.GetDot(x, y));
+      }
+    }
+  }
+}
+
+//-----------------------
+// Function: isSameFrame
+//-----------------------
+static bool isSameFrame(DmdFrame& frame, DmdFrame& reference)
+{
+  for(int y = 0; y < frame.GetHeight(); y++)
+  {
+    for(int x = 0; x < frame.GetWidth(); x++)
+    {
+      if(frame.GetDotRgb(x, y) != reference.GetDotRgb(x, y))
+      {
+        printf("dot %d,%d is %03X, not %03X\n", x, y, frame.GetDotRgb(x, y), reference.GetDotRgb(x, y));
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+int main()
+{
+  static DmdFrame frame, reference;
+  Dotmap dmp;
+
+  frame.SetTint(DmdTintGreen);
+  reference.SetTint(DmdTintGreen);
+
+  for(const BltCase& bltCase : cases)
+  {
+    createDotmap(dmp, bltCase.width, bltCase.height, bltCase.x + 1000);
+
+    // Drawn over a background the transparent dots show
+    frame.Clear(0x05);
+    reference.Clear(0x05);
+    frame.DotBlt(dmp, 0, 0, dmp.GetWidth(), dmp.GetHeight(), bltCase.x, bltCase.y);
+    referenceBlt(reference, dmp, bltCase.x, bltCase.y);
+    if(!CHECK(isSameFrame(frame, reference)))
+    {
+      printf("%s at %d,%d\n", bltCase.name, bltCase.x, bltCase.y);
+      continue;
+    }
+
+    // Timed over many, same frame each time
+    auto start = std::chrono::steady_clock::now();
+
+    for(int idx = 0; idx < cntTimed; idx++)
+    {
+      frame.DotBlt(dmp, 0, 0, dmp.GetWidth(), dmp.GetHeight(), bltCase.x, bltCase.y);
+    }
+
+    auto middle = std::chrono::steady_clock::now();
+
+    for(int idx = 0; idx < cntTimed; idx++)
+    {
+      referenceBlt(reference, dmp, bltCase.x, bltCase.y);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double nanosBlt = std::chrono::duration<double, std::nano>(middle - start).count() / cntTimed;
+    double nanosReference = std::chrono::duration<double, std::nano>(end - middle).count() / cntTimed;
+
+    printf("%-18s %3dx%-2d at %4d,%-3d %9.0fns, a dot at a time %9.0fns\n", bltCase.name, bltCase.width, bltCase.height,
+      bltCase.x, bltCase.y, nanosBlt, nanosReference);
+  }
+
+  return hostReport("TestDotBlt");
+}
@@ -0,0 +1,75 @@
+#include <algorithm>
+
+#include "Host.h"
+
+// On time of every row at each brightness, the share of its plane's time the enable driver lights it for
+// Whatever the plane, no row is left dark
+
+// The driver's default plane times
+const int cntPlanesDefault = 4;
+const uint16_t microsPlanesDefault[cntPlanesDefault] = { 1, 2, 30, 45 };
+
+// Slack for the isr's own cycles, an on time of near the whole plane may be cut that much short by the next latch
+const uint64_t cyclesSlack = 12;
+
+int main()
+{
+  // Pin writes and port stores for free, the rows take no time and none cuts the on time before it short
+  hostConfig.cyclesPinWrite = 0;
+  hostConfig.cyclesPortWrite = 0;
+
+  dmd.Initialise();
+  dmd.Start();
+
+  for(int brightness = 0; brightness < 64; brightness++)
+  {
+    std::vector<std::pair<uint64_t, uint64_t>> expected;
+    std::vector<uint64_t> measured;
+
+    // Taken up at the start of a refresh, so measure from the one after
+    CHECK(dmd.SetBrightness(brightness));
+    CHECK(dmd.WaitRefresh(100000));
+    CHECK(dmd.WaitRefresh(100000));
+    hostPanel.pulses.clear();
+    CHECK(hostRunLatches((DmdScan * cntPlanesDefault) + 1));
+
+    // Any refresh worth of rows in a row has each plane's on time once a row address
+    for(int plane = 0; plane < cntPlanesDefault; plane++)
+    {
+      uint64_t cyclesPlane = microsPlanesDefault[plane] * HostCyclesMicro;
+      uint64_t cycles = max((uint64_t)((cyclesPlane * (brightness + 1) / 64.0) + 0.5), (uint64_t)1);
+
+      expected.insert(expected.end(), DmdScan, std::make_pair(cycles, min(cycles, cyclesPlane - cyclesSlack)));
+    }
+
+    for(int pulse = 0; pulse < DmdScan * cntPlanesDefault && pulse < (int)hostPanel.pulses.size(); pulse++)
+    {
+      measured.push_back(hostPanel.pulses[pulse].cycles);
+    }
+
+    if(!CHECK(measured.size() == expected.size()))
+    {
+      break;
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(measured.begin(), measured.end());
+    for(size_t idx = 0; idx < expected.size(); idx++)
+    {
+      if(!CHECK(measured[idx] + 1 >= expected[idx].second && measured[idx] <= expected[idx].first + cyclesSlack))
+      {
+        printf("brightness %d on time %llu cycles, not %llu\n", brightness, (unsigned long long)measured[idx], (unsigned long long)expected[idx].first);
+        break;
+      }
+    }
+  }
+
+  // Dark for every latch, and the one shot never started or stopped with interrupts off
+  CHECK(hostPanel.cntGlitches == 0);
+  CHECK(hostTimer(190) != NULL && hostTimer(190)->cntBegins > 0 && hostTimer(190)->cntIrqOffCalls == 0);
+
+  dmd.Stop();
+  CHECK(hostPanel.Read(DmdPinout::pinEN) == HIGH);
+
+  return hostReport("TestEnable");
+}
@@ -0,0 +1,220 @@
+#include <algorithm>
+
+#include "Host.h"
+
+// Packed frames against a dot a word model, random clears, fills, masked blits, composites and copies of
+// dotmaps of any size and alignment, on or off the frame, each checked bit for bit
+
+const int cntOps = 10000;
+const int cntDotmaps = 6;
+
+// What GetDotRgb should give for each dot of a frame
+struct FrameModel
+{
+  uint16_t dots[DmdHeight][DmdWidth];
+};
+
+static uint32_t seed = 7;
+
+//--------------------
+// Function: randomInt
+//--------------------
+static int randomInt(int lowest, int highest)
+{
+  seed = (seed * 1103515245) + 12345;
+
+  return lowest + (int)((seed >> 8) % (uint32_t)(highest - lowest + 1));
+}
+
+//-----------------
+// Function: tinted
+//-----------------
+static uint16_t tinted(byte level, byte tint)
+{
+  // A mono frame's level reads back in every channel, a colour frame's only in those of the tint
+  level &= 0x0F;
+  if(DmdChannels == 1)
+  {
+    return (level << 8) | (level << 4) | level;
+  }
+
+  return (tint & DmdTintRed ? level << 8 : 0) | (tint & DmdTintGreen ? level << 4 : 0) | (tint & DmdTintBlue ? level : 0);
+}
+
+//-----------------------
+// Function: createDotmap
+//-----------------------
+static void createDotmap(Dotmap& dmp)
+{
+  int width = randomInt(1, 80);
+  int height = randomInt(1, 20);
+  int density = randomInt(0, 4);
+
+  // From wholly opaque to wholly transparent
+  dmp.Create(width, height);
+  for(int y = 0; y < height; y++)
+  {
+    for(int x = 0; x < width; x++)
+    {
+      dmp.SetDot(x, y, randomInt(0, 15));
+      dmp.SetMask(x, y, randomInt(0, 3) < density);
+    }
+  }
+}
+
+//----------------------
+// Function: modelDotmap
+//----------------------
+static void modelDotmap(FrameModel& model, Dotmap& dmp, int sourceX, int sourceY, int sourceWidth, int sourceHeight, int destX,
+  int destY, bool isMasked, byte tint)
+{
+  for(int y = max(sourceY, 0); y < min(sourceY + sourceHeight, dmp.GetHeight()); y++)
+  {
+    for(int x = max(sourceX, 0); x < min(sourceX + sourceWidth, dmp.GetWidth()); x++)
+    {
+      int xDest = destX + x - sourceX;
+      int yDest = destY + y - sourceY;
+
+      if(xDest >= 0 && xDest < DmdWidth && yDest >= 0 && yDest < DmdHeight && !(isMasked && dmp.GetMask(x, y)))
+      {
+        model.dots[yDest][xDest] = tinted(dmp.GetDot(x, y), tint);
+      }
+    }
+  }
+}
+
+//----------------------
+// Function: isSameFrame
+//----------------------
+static bool isSameFrame(DmdFrame& frame, FrameModel& model)
+{
+  for(int y = 0; y < DmdHeight; y++)
+  {
+    for(int x = 0; x < DmdWidth; x++)
+    {
+      if(frame.GetDotRgb(x, y) != model.dots[y][x])
+      {
+        printf("dot %d,%d is %03X, not %03X\n", x, y, frame.GetDotRgb(x, y), model.dots[y][x]);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+int main()
+{
+  static DmdFrame frames[2];
+  static FrameModel models[2];
+  Dotmap dmps[cntDotmaps];
+  const byte tint = DmdTintRed | DmdTintBlue;
+
+  for(int idx = 0; idx < 2; idx++)
+  {
+    frames[idx].SetTint(tint);
+    frames[idx].Clear();
+    std::fill_n(&models[idx].dots[0][0], DmdHeight * DmdWidth, 0x000);
+  }
+
+  for(int op = 0; op < cntOps; op++)
+  {
+    int idxFrame = randomInt(0, 1);
+    DmdFrame& frame = frames[idxFrame];
+    FrameModel& model = models[idxFrame];
+    Dotmap& dmp = dmps[randomInt(0, cntDotmaps - 1)];
+    int kind = randomInt(0, 5);
+
+    // New dotmaps as they go
+    if(dmp.GetWidth() == 0 || randomInt(0, 9) == 0)
+    {
+      createDotmap(dmp);
+    }
+
+    if(kind == 0)
+    {
+      byte level = randomInt(0, 15);
+
+      frame.Clear(level);
+      std::fill_n(&model.dots[0][0], DmdHeight * DmdWidth, tinted(level, tint));
+    }
+    else
+    if(kind == 1)
+    {
+      int x = randomInt(-20, DmdWidth + 4);
+      int y = randomInt(-8, DmdHeight + 2);
+      int fillWidth = randomInt(-2, 60);
+      int fillHeight = randomInt(-2, 20);
+      byte level = randomInt(0, 15);
+
+      frame.Fill(x, y, fillWidth, fillHeight, level);
+      for(int yFill = max(y, 0); yFill < min(y + fillHeight, DmdHeight); yFill++)
+      {
+        for(int xFill = max(x, 0); xFill < min(x + fillWidth, DmdWidth); xFill++)
+        {
+          model.dots[yFill][xFill] = tinted(level, tint);
+        }
+      }
+    }
+    else
+    if(kind == 2 || kind == 3)
+    {
+      // Part of the dotmap or past its edges, anywhere on or off the frame
+      int sourceX = randomInt(-4, dmp.GetWidth() / 2);
+      int sourceY = randomInt(-2, dmp.GetHeight() / 2);
+      int sourceWidth = randomInt(0, dmp.GetWidth() + 4);
+      int sourceHeight = randomInt(0, dmp.GetHeight() + 2);
+      int destX = randomInt(-dmp.GetWidth(), DmdWidth);
+      int destY = randomInt(-dmp.GetHeight(), DmdHeight);
+
+      frame.DotBlt(dmp, sourceX, sourceY, sourceWidth, sourceHeight, destX, destY);
+      modelDotmap(model, dmp, sourceX, sourceY, sourceWidth, sourceHeight, destX, destY, true, tint);
+    }
+    else
+    if(kind == 4)
+    {
+      DmdLayer layers[DmdLayersMax];
+      int cntLayers = randomInt(0, DmdLayersMax);
+      byte background = randomInt(0, 15);
+
+      for(int idxLayer = 0; idxLayer < cntLayers; idxLayer++)
+      {
+        Dotmap& dmpLayer = dmps[randomInt(0, cntDotmaps - 1)];
+
+        if(dmpLayer.GetWidth() == 0)
+        {
+          createDotmap(dmpLayer);
+        }
+        layers[idxLayer] = { &dmpLayer, randomInt(-dmpLayer.GetWidth(), DmdWidth), randomInt(-dmpLayer.GetHeight(), DmdHeight),
+          randomInt(0, 3), randomInt(0, 1) == 1 };
+      }
+
+      frame.Composite(layers, cntLayers, background);
+
+      // Background, then the layers lowest first, those of equal z as given
+      std::fill_n(&model.dots[0][0], DmdHeight * DmdWidth, tinted(background, tint));
+      std::stable_sort(layers, layers + cntLayers, [](const DmdLayer& a, const DmdLayer& b) { return a.z < b.z; });
+      for(int idxLayer = 0; idxLayer < cntLayers; idxLayer++)
+      {
+        Dotmap& dmpLayer = *layers[idxLayer].dmp;
+
+        modelDotmap(model, dmpLayer, 0, 0, dmpLayer.GetWidth(), dmpLayer.GetHeight(), layers[idxLayer].x, layers[idxLayer].y,
+          layers[idxLayer].isMasked, tint);
+      }
+    }
+    else
+    {
+      // Whole frame copied over the other
+      frames[1 - idxFrame] = frame;
+      models[1 - idxFrame] = model;
+    }
+
+    if(!CHECK(isSameFrame(frames[0], models[0]) && isSameFrame(frames[1], models[1])))
+    {
+      printf("op %d, kind %d\n", op, kind);
+      break;
+    }
+  }
+
+  return hostReport("TestFramePacked");
+}
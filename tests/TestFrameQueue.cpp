@@ -0,0 +1,116 @@
+#include <atomic>
+#include <thread>
+
+#include "Host.h"
+
+// Renderer and refresh isr on threads of their own either side of the frame queue, built with the thread sanitizer
+// The renderer presents frames of every dot off then every dot on as fast as the queue takes them, while the
+// isr thread refreshes back to back, no refresh may show parts of two frames and the last presented is shown
+
+const int cntFrames = 500;
+
+static std::atomic<bool> isRendering(true);
+
+// Isr thread only, the rows of the refresh under way and what was found
+static int idxLatch = -1;
+static DmdLaneCode codeRefresh;
+static bool isTorn;
+static uint32_t cntTorn = 0;
+static uint32_t cntChecked = 0;
+static DmdLaneCode codeLast;
+
+//--------------------
+// Function: checkRow
+//--------------------
+static void checkRow(const HostLatch& latch)
+{
+  // Top and bottom red lanes of every pulse of every row of every plane the same, the frame's one level
+  for(int pulse = 0; pulse < DmdScanPulses; pulse++)
+  {
+    DmdLaneCode code = latch.lanes[pulse] & (DmdLaneR1 | DmdLaneR2);
+
+    if(idxLatch == 0 && pulse == 0)
+    {
+      codeRefresh = code;
+      isTorn = false;
+    }
+
+    isTorn |= (code != codeRefresh);
+  }
+}
+
+//--------------------
+// Function: isrThread
+//--------------------
+static void isrThread()
+{
+  int cntDrain = 0;
+
+  // Some refreshes more once rendering is over, to take up the last frame
+  while(isRendering.load() || cntDrain++ < DmdScan * DmdPlanesMax * 4)
+  {
+    uint32_t cntRefreshes = dmd.GetRefreshCount();
+
+    hostPanel.latches.clear();
+    noInterrupts();
+    dmd.IsrDmd();
+    interrupts();
+
+    // Each call latches a row, the refresh ends with it or the next one starts
+    if(idxLatch >= 0 && hostPanel.latches.size() == 1)
+    {
+      checkRow(hostPanel.latches[0]);
+      idxLatch++;
+    }
+
+    if(dmd.GetRefreshCount() != cntRefreshes)
+    {
+      if(idxLatch > 0)
+      {
+        cntTorn += isTorn;
+        cntChecked++;
+        codeLast = codeRefresh;
+      }
+      idxLatch = 0;
+    }
+  }
+}
+
+int main()
+{
+  // The isr thread calls the isr itself
+  hostConfig.isScheduled = false;
+  hostPanel.isRecordingLatches = true;
+
+  dmd.Initialise();
+  dmd.Start();
+
+  std::thread isr(isrThread);
+
+  // The renderer never waits on the isr, only for room in the queue
+  for(int idxFrame = 0; idxFrame < cntFrames; idxFrame++)
+  {
+    DmdFrame& frame = dmd.AcquireBackBuffer();
+
+    frame.Clear((idxFrame & 0x01) ? 0x0F : 0x00);
+    while(!dmd.Present())
+    {
+      yield();
+    }
+  }
+  CHECK(dmd.WaitSync(1000000));
+
+  isRendering.store(false);
+  isr.join();
+
+  CHECK(cntChecked > 0);
+  CHECK(cntTorn == 0);
+  CHECK(dmd.GetPresentedCount() > 0);
+
+  // Last frame presented was all on
+  CHECK(codeLast == (DmdLaneR1 | DmdLaneR2));
+
+  dmd.Stop();
+
+  return hostReport("TestFrameQueue");
+}
@@ -0,0 +1,113 @@
+#include "Host.h"
+
+// Colour dotmaps blitted and composited into a frame, a colour frame keeps their colour and a mono one takes
+// the level of each dot's brightest channel, as SetDotRgb does
+
+//------------------------
+// Function: createDotmap
+//------------------------
+static void createDotmap(Dotmap& dmp, int width, int height, uint32_t seed)
+{
+  dmp.Create(width, height, Dotmap::BppRgb);
+
+  for(int y = 0; y < height; y++)
+  {
+    for(int x = 0; x < width; x++)
+    {
+      seed = (seed * 1103515245) + 12345;
+      dmp.SetDotRgb(x, y, (seed >> 8) & 0x0FFF);
+      dmp.SetMask(x, y, (seed >> 24) % 5 == 0);
+    }
+  }
+}
+
+//------------------------
+// Function: referenceBlt
+//------------------------
+static void referenceBlt(DmdFrame& frame, Dotmap& dmp, int destX, int destY, bool isMasked)
+{
+  // A dot at a time through the dotmap's and frame's own accessors
+  for(int y = 0; y < dmp.GetHeight(); y++)
+  {
+    for(int x = 0; x < dmp.GetWidth(); x++)
+    {
+      if(!isMasked || !dmp.GetMask(x, y))
+      {
+        frame.SetDotRgb(destX + x, destY + y, dmp.GetDotRgb(x, y));
+      }
+    }
+  }
+}
+
+//------------------------
+// Function: isSameFrame
+//------------------------
+static bool isSameFrame(DmdFrame& frame, DmdFrame& reference)
+{
+  for(int y = 0; y < frame.GetHeight(); y++)
+  {
+    for(int x = 0; x < frame.GetWidth(); x++)
+    {
+      if(frame.GetDotRgb(x, y) != reference.GetDotRgb(x, y))
+      {
+        printf("dot %d,%d is 0x%03X, not 0x%03X\n", x, y, frame.GetDotRgb(x, y), reference.GetDotRgb(x, y));
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static DmdFrame frame;
+static DmdFrame reference;
+
+int main()
+{
+  Dotmap dmp;
+  const int positions[][2] = { { 0, 0 }, { 3, 1 }, { 10, 5 }, { -7, -2 }, { DmdWidth - 20, DmdHeight - 4 } };
+
+  createDotmap(dmp, 37, 9, 1);
+
+  // Blits at even and odd columns, and clipped
+  for(const auto& position : positions)
+  {
+    frame.Clear(0x03);
+    reference.Clear(0x03);
+
+    frame.DotBlt(dmp, 0, 0, dmp.GetWidth(), dmp.GetHeight(), position[0], position[1]);
+    referenceBlt(reference, dmp, position[0], position[1], true);
+    CHECK(isSameFrame(frame, reference));
+  }
+
+  // Composited over a background, masked and not
+  for(const auto& position : positions)
+  {
+    DmdLayer layers[2] = { { &dmp, position[0], position[1], 0, false }, { &dmp, position[0] + 5, position[1] + 2, 1, true } };
+
+    reference.Clear(0x05);
+    referenceBlt(reference, dmp, position[0], position[1], false);
+    referenceBlt(reference, dmp, position[0] + 5, position[1] + 2, true);
+
+    frame.Composite(layers, 2, 0x05);
+    CHECK(isSameFrame(frame, reference));
+  }
+
+  // Mono, a dot with a single channel lit comes out at that channel's level
+  if(DmdChannels == 1)
+  {
+    Dotmap dmpSingle;
+
+    dmpSingle.Create(2, 1, Dotmap::BppRgb);
+    dmpSingle.ClearMask();
+    dmpSingle.SetDotRgb(0, 0, 0x00F);
+    dmpSingle.SetDotRgb(1, 0, 0x0A0);
+
+    frame.Clear();
+    frame.DotBlt(dmpSingle, 0, 0, 2, 1, 0, 0);
+    CHECK(frame.GetDot(0, 0) == 0x0F);
+    CHECK(frame.GetDot(1, 0) == 0x0A);
+  }
+
+  return hostReport("TestFrameRgb");
+}
@@ -0,0 +1,82 @@
+#include "Host.h"
+
+// Governor decisions on the isr load, rows made to take longer than the short planes by dearer port stores
+// ease the refresh a plane at a time until the load is back under its threshold, and cheap ones restore it
+
+// The governor eases the refresh above this much of the time in the isr, percent
+const uint32_t dutyHigh = 60;
+
+// A slow refresh keeps the rows to simulate few, its shortest planes about 40us
+const int hzRefresh = 100;
+
+// Dearer stores, about 140us a row, and as cheap as can be
+const uint32_t cyclesPortWriteHigh = 40;
+const uint32_t cyclesPortWriteLow = 0;
+
+// The governor steps once a profile, a second, and skips the one a step was made in
+const uint32_t microsSettle = 8000000;
+
+//---------------------
+// Function: presentFor
+//---------------------
+static void presentFor(uint32_t micros)
+{
+  // The governor decides as frames are presented, a renderer at 50fps
+  for(uint32_t elapsed = 0; elapsed < micros; elapsed += 20000)
+  {
+    dmd.AcquireBackBuffer().Clear(0x0F);
+    dmd.Present();
+    hostRunMicros(20000);
+  }
+}
+
+int main()
+{
+  DmdStats stats;
+  int cntPlanes;
+  uint32_t cntChanges;
+
+  hostConfig.cyclesPortWrite = cyclesPortWriteLow;
+
+  dmd.Initialise();
+  dmd.Start();
+  CHECK(dmd.Calibrate(hzRefresh));
+  cntPlanes = dmd.GetPlanes();
+
+  // Light load, nothing to ease
+  presentFor(1100000);
+  CHECK(dmd.GetGovernLevel() == 0);
+  CHECK(dmd.GetGovernChanges() == 0);
+  CHECK(dmd.GetPlanes() == cntPlanes);
+
+  // Rows longer than the short planes, the isr takes most of the time until planes are given up
+  hostConfig.cyclesPortWrite = cyclesPortWriteHigh;
+  presentFor(microsSettle);
+  dmd.GetStats(stats);
+  cntChanges = dmd.GetGovernChanges();
+  if(!CHECK(dmd.GetGovernLevel() > 0 && dmd.GetPlanes() < cntPlanes && stats.dutyIsr <= dutyHigh))
+  {
+    printf("level %d, %d planes, isr duty %u%%\n", dmd.GetGovernLevel(), dmd.GetPlanes(), stats.dutyIsr);
+  }
+  CHECK(cntChanges == (uint32_t)dmd.GetGovernLevel());
+
+  // The frames on screen carry the planes the governor left
+  CHECK(stats.cntPlanes == dmd.GetPlanes());
+
+  // Steady at the eased level
+  presentFor(3000000);
+  CHECK(dmd.GetGovernChanges() == cntChanges);
+
+  // Load dropped, restored a step at a time, each logged
+  hostConfig.cyclesPortWrite = cyclesPortWriteLow;
+  presentFor(microsSettle);
+  dmd.GetStats(stats);
+  CHECK(dmd.GetGovernLevel() == 0);
+  CHECK(dmd.GetPlanes() == cntPlanes);
+  CHECK(stats.cntPlanes == cntPlanes);
+  CHECK(dmd.GetGovernChanges() == cntChanges * 2);
+
+  dmd.Stop();
+
+  return hostReport("TestGovern");
+}
@@ -0,0 +1,135 @@
+#include <chrono>
+
+#include "Host.h"
+#include "DmdNibbles.h"
+
+// Compositing kernels cross checked, the USUB8 and SEL nibble masks, emulated off target, against the shift and
+// mask ones and a bit at a time reference for every mask byte, and the word at a time clears and fills against
+// the dots read back, then each timed
+
+const int cntTimed = 2000;
+
+static volatile uint32_t sink;
+
+//-----------------------
+// Function: nanosPerCall
+//-----------------------
+template<class Kernel>
+static double nanosPerCall(int cnt, Kernel kernel)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  for(int idx = 0; idx < cnt; idx++)
+  {
+    kernel(idx);
+  }
+
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / cnt;
+}
+
+//-----------------------------
+// Function: isDotmapFilledWith
+//-----------------------------
+static bool isDotmapFilledWith(Dotmap& dmp, byte level)
+{
+  for(int y = 0; y < dmp.GetHeight(); y++)
+  {
+    for(int x = 0; x < dmp.GetWidth(); x++)
+    {
+      uint16_t expected = (dmp.GetBpp() == Dotmap::BppRgb ? (level << 8) | (level << 4) | level : level);
+      uint16_t dot = (dmp.GetBpp() == Dotmap::BppRgb ? dmp.GetDotRgb(x, y) : dmp.GetDot(x, y));
+
+      if(dot != expected)
+      {
+        printf("%dx%d dotmap dot %d,%d is %03X, not %03X\n", dmp.GetWidth(), dmp.GetHeight(), x, y, dot, expected);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+int main()
+{
+  static DmdFrame frame;
+  Dotmap dmp;
+
+  // Every mask byte, a nibble of ones for each bit set
+  for(uint32_t bits = 0; bits < 0x100; bits++)
+  {
+    uint32_t expected = 0;
+
+    for(int dot = 0; dot < 8; dot++)
+    {
+      expected |= (bits & (1 << dot)) ? 0x0Fu << (dot * 4) : 0;
+    }
+
+    if(!CHECK(nibbleMaskDsp(bits) == expected && nibbleMaskPortable(bits) == expected && nibbleMask(bits) == expected))
+    {
+      printf("bits %02X give %08X and %08X, not %08X\n", bits, nibbleMaskDsp(bits), nibbleMaskPortable(bits), expected);
+    }
+  }
+
+  // Select a byte at a time, the clear operand where the byte is zero
+  CHECK(selectBytes(0x00000000, 0x11223344, 0xAABBCCDD) == 0xAABBCCDD);
+  CHECK(selectBytes(0xFF000100, 0x11223344, 0xAABBCCDD) == 0x11BB33DD);
+  CHECK(selectBytes(0x80808080, 0x11223344, 0xAABBCCDD) == 0x11223344);
+
+  // Every level cleared to a frame, read back a dot at a time
+  for(byte level = 0; level < 16; level++)
+  {
+    bool isCleared = true;
+
+    frame.Clear(level);
+    for(int y = 0; y < frame.GetHeight() && isCleared; y++)
+    {
+      for(int x = 0; x < frame.GetWidth() && isCleared; x++)
+      {
+        isCleared = (frame.GetDot(x, y) == level);
+      }
+    }
+    CHECK(isCleared);
+  }
+
+  // Mono and colour dotmaps filled, odd widths and heights leaving a word over, read back a dot at a time
+  for(int bpp : { (int)Dotmap::BppMono, (int)Dotmap::BppRgb })
+  {
+    for(int width = 1; width <= 9; width++)
+    {
+      for(int height = 1; height <= 3; height++)
+      {
+        dmp.Create(width, height, bpp);
+        dmp.Fill(width + height);
+        CHECK(isDotmapFilledWith(dmp, (width + height) & 0x0F));
+      }
+    }
+  }
+
+  // Throughput, a mask byte, a frame or a frame sized dotmap a call
+  double nanosMaskDsp = nanosPerCall(cntTimed * 100, [](int idx) { sink = nibbleMaskDsp(idx & 0xFF); });
+  double nanosMaskPortable = nanosPerCall(cntTimed * 100, [](int idx) { sink = nibbleMaskPortable(idx & 0xFF); });
+  double nanosClear = nanosPerCall(cntTimed, [](int idx) { frame.Clear(idx); });
+
+  dmp.Create(DmdWidth, DmdHeight);
+  for(int y = 0; y < DmdHeight; y++)
+  {
+    for(int x = 0; x < DmdWidth; x++)
+    {
+      dmp.SetMask(x, y, ((x * 7) + y) % 5 == 0);
+    }
+  }
+
+  double nanosBlt = nanosPerCall(cntTimed, [&dmp](int idx) { frame.DotBlt(dmp, 0, 0, DmdWidth, DmdHeight, idx & 0x01, 0); });
+  double nanosFill = nanosPerCall(cntTimed, [&dmp](int idx) { dmp.Fill(idx); });
+
+  dmp.Create(DmdWidth, DmdHeight, Dotmap::BppRgb);
+
+  double nanosFillRgb = nanosPerCall(cntTimed, [&dmp](int idx) { dmp.Fill(idx); });
+
+  printf("nibble mask USUB8 and SEL emulated %.1fns, shift and mask %.1fns\n", nanosMaskDsp, nanosMaskPortable);
+  printf("%dx%d frame clear %.0fns, masked blit %.0fns, dotmap fill %.0fns, colour dotmap fill %.0fns\n", DmdWidth, DmdHeight,
+    nanosClear, nanosBlt, nanosFill, nanosFillRgb);
+
+  return hostReport("TestNibbles");
+}
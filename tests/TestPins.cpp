@@ -0,0 +1,74 @@
+#include "Host.h"
+
+// Pin and port writes of each row of the scanout, with the pinout fixed at compile time every one is a single store
+
+//--------------------
+// Function: portCount
+//--------------------
+static int portCount()
+{
+  const int pinLanes[12] = { DmdPinout::pinR1, DmdPinout::pinG1, DmdPinout::pinB1, DmdPinout::pinR2, DmdPinout::pinG2, DmdPinout::pinB2,
+                             DmdPinout::pinR3, DmdPinout::pinG3, DmdPinout::pinB3, DmdPinout::pinR4, DmdPinout::pinG4, DmdPinout::pinB4 };
+  bool isUsed[64] = {};
+  int cntPorts = 0;
+
+  // Ports of the data lines in use and the clock
+  for(int lane = 0; lane < DmdLanesChain * DmdChains; lane++)
+  {
+    if(DmdPinout::hasBlue || (lane % 3) != 2)
+    {
+      isUsed[hostPinPort(pinLanes[lane])] = true;
+    }
+  }
+  isUsed[hostPinPort(DmdPinout::pinSK)] = true;
+
+  for(int port = 0; port < 64; port++)
+  {
+    cntPorts += isUsed[port];
+  }
+
+  return cntPorts;
+}
+
+int main()
+{
+  int cntPorts = portCount();
+
+  dmd.Initialise();
+  dmd.Start();
+
+  // Settle into the scan, then count the writes of a refresh worth of rows, each from one latch to the next
+  CHECK(hostRunLatches(DmdScan * dmd.GetPlanes()));
+  hostPanel.isCountingRows = true;
+  CHECK(hostRunLatches(DmdScan * dmd.GetPlanes()));
+  hostPanel.isCountingRows = false;
+
+  CHECK(hostPanel.rows.size() >= (size_t)(DmdScan * dmd.GetPlanes()));
+  for(const HostCounts& counts : hostPanel.rows)
+  {
+    // Per clock pulse a clear and a set store for each port and one to take the clock HIGH
+    CHECK(counts.cntPortWrites == (uint32_t)(DmdScanPulses * ((cntPorts * 2) + 1)));
+
+    // Latch pulse and the row address, whatever their level
+    CHECK(counts.pinWrites[DmdPinout::pinLT] == 2);
+    CHECK(counts.pinWrites[DmdPinout::pinLA] == 1);
+    CHECK(counts.pinWrites[DmdPinout::pinLB] == 1);
+    CHECK(counts.pinWrites[DmdPinout::pinLC] == 1);
+    CHECK(counts.pinWrites[DmdPinout::pinLD] == 1);
+
+    // Data lines and the clock only ever go out as port words
+    CHECK(counts.pinWrites[DmdPinout::pinR1] == 0);
+    CHECK(counts.pinWrites[DmdPinout::pinG2] == 0);
+    CHECK(counts.pinWrites[DmdPinout::pinSK] == 0);
+
+    // Enable is off for the latch, on after it and off again once the on time is up
+    CHECK(counts.pinWrites[DmdPinout::pinEN] <= 3);
+  }
+
+  // Nothing changed under a lit row
+  CHECK(hostPanel.cntGlitches == 0);
+
+  dmd.Stop();
+
+  return hostReport("TestPins");
+}
@@ -0,0 +1,145 @@
+#include "Host.h"
+
+// Each plane count scanned out over whole refreshes against a model of the binary planes, the refresh rate
+// and every level's share of the refresh it is lit for
+
+// The driver's default plane times, kept as the total the planes share out
+const int microsTotalDefault = 1 + 2 + 30 + 45;
+
+const int cntRefreshesMeasured = 8;
+
+// Slack for the isr's own cycles at either end of an on time
+const uint64_t cyclesSlack = 12;
+
+// Rows lit from one refresh callback to another
+static int cntRefreshesLeft = -1;
+static uint64_t cyclesWindow;
+static std::vector<uint64_t> litWindow;
+
+//--------------------
+// Function: onRefresh
+//--------------------
+static void onRefresh(uint32_t cntRefreshes)
+{
+  // The last row's on time is under way, in the window at its start and not at its end, so every row address
+  // is counted for the same refreshes
+  if(cntRefreshesLeft == cntRefreshesMeasured)
+  {
+    hostPanel.ClearLit();
+    cyclesWindow = hostCycles();
+  }
+  if(cntRefreshesLeft == 0)
+  {
+    litWindow = hostPanel.lit;
+    cyclesWindow = hostCycles() - cyclesWindow;
+  }
+  if(cntRefreshesLeft >= 0)
+  {
+    cntRefreshesLeft--;
+  }
+}
+
+//--------------------------
+// Function: modelLevelValue
+//--------------------------
+static int modelLevelValue(int level, int cntPlanes)
+{
+  int valueMax = (1 << cntPlanes) - 1;
+  int value = 0;
+
+  // At a gamma of 1 levels are spread evenly over the planes' range, each distinct while the planes allow
+  for(int step = 1; step <= level; step++)
+  {
+    value = max((int)((step * valueMax / 15.0f) + 0.5f), min(value + 1, valueMax));
+  }
+
+  return value;
+}
+
+int main()
+{
+  // Pin writes and port stores for free, the rows take no time and none cuts the on time before it short
+  hostConfig.cyclesPinWrite = 0;
+  hostConfig.cyclesPortWrite = 0;
+
+  dmd.Initialise();
+  dmd.SetDmdType(0);
+  dmd.SetRefreshCallback(onRefresh);
+  dmd.Start();
+  CHECK(dmd.SetBrightness(63));
+
+  for(int cntPlanes = DmdPlanesMin; cntPlanes <= DmdPlanesMax; cntPlanes++)
+  {
+    // The model, the default total shared out in binary weights, each plane shown for the whole microseconds
+    // its on time needs
+    float microsUnit = (float)microsTotalDefault / ((1 << cntPlanes) - 1);
+    int microsRefreshRow = 0;
+
+    for(int plane = 0; plane < cntPlanes; plane++)
+    {
+      microsRefreshRow += (int)ceilf(microsUnit * (1 << plane));
+    }
+
+    float hzModel = 1000000.0f / (DmdScan * microsRefreshRow);
+    float dutyFull = (float)microsTotalDefault / microsRefreshRow;
+
+    // Every column a level of its own, timings go with the frame
+    CHECK(dmd.SetPlanes(cntPlanes));
+    DmdFrame& frame = dmd.AcquireBackBuffer();
+
+    for(int y = 0; y < DmdHeight; y++)
+    {
+      for(int x = 0; x < DmdWidth; x++)
+      {
+        frame.SetDot(x, y, x % 16);
+      }
+    }
+    CHECK(dmd.Present());
+
+    // On screen, then whole refreshes of it measured
+    CHECK(dmd.WaitRefresh(100000));
+    CHECK(dmd.WaitRefresh(100000));
+    cntRefreshesLeft = cntRefreshesMeasured;
+    for(int refresh = 0; refresh < cntRefreshesMeasured + 2; refresh++)
+    {
+      CHECK(dmd.WaitRefresh(100000));
+    }
+
+    if(!CHECK(cntRefreshesLeft < 0 && dmd.GetPlanes() == cntPlanes))
+    {
+      break;
+    }
+
+    float hz = (float)cntRefreshesMeasured * F_CPU / cyclesWindow;
+
+    if(!CHECK(hz >= hzModel * 0.98f && hz <= hzModel * 1.02f))
+    {
+      printf("%d planes refresh at %.1fHz, not %.1fHz\n", cntPlanes, hz, hzModel);
+    }
+
+    // Each level lit for its value's share of the full level, of the top row of the top chain on the red lane
+    for(int level = 0; level < 16; level++)
+    {
+      int value = modelLevelValue(level, cntPlanes);
+      int cntPulses = 0;
+
+      for(int plane = 0; plane < cntPlanes; plane++)
+      {
+        cntPulses += (value >> plane) & 0x01;
+      }
+
+      uint64_t lit = litWindow[(level * DmdLanesChain * DmdChains) + 0];
+      double litModel = dutyFull * value / ((1 << cntPlanes) - 1) * cyclesWindow / DmdScan;
+      double litTolerance = (cyclesSlack * cntPulses * cntRefreshesMeasured) + (litModel * 0.02);
+
+      if(!CHECK(lit + litTolerance >= litModel && lit <= litModel + litTolerance))
+      {
+        printf("%d planes level %d lit for %llu cycles, not %.0f\n", cntPlanes, level, (unsigned long long)lit, litModel);
+      }
+    }
+  }
+
+  dmd.Stop();
+
+  return hostReport("TestPlanes");
+}
@@ -0,0 +1,97 @@
+#include "Host.h"
+
+// Writes and cycles of a row of the shift kernel against a model of the pin at a time row updates it replaced,
+// UpdateRowType0 and UpdateRowType1, which differed only in inverting the data
+
+// Operations of a row of the old updates, counted off their source
+struct RowOps
+{
+  uint32_t cntPinWrites;
+  uint32_t cntOther;
+};
+
+//----------------------
+// Function: modelOldRow
+//----------------------
+static RowOps modelOldRow(int brightness)
+{
+  RowOps ops = { 0, 0 };
+  int cntChannels = DmdPinout::hasBlue ? 3 : 2;
+
+  // Colour masks from the colour every row
+  ops.cntOther += 3;
+
+  // A column a clock pulse for a top and a bottom dot, however many chains the dots are spread over
+  for(int col = 0; col < DmdWidth * DmdHeight / (2 * DmdScan); col++)
+  {
+    // Brightness compare, enable off at its column
+    ops.cntOther++;
+    if(col == brightness)
+    {
+      ops.cntPinWrites++;
+    }
+
+    // Top and bottom dot masked by the plane, inverted on a type 1 screen
+    ops.cntOther += 2;
+
+    // Clock LOW, each channel's masked data line top and bottom, clock HIGH
+    ops.cntPinWrites += 2 + (cntChannels * 2);
+    ops.cntOther += cntChannels * 2;
+  }
+
+  // Latch, row address, latch, enable
+  ops.cntPinWrites += 7;
+
+  return ops;
+}
+
+int main()
+{
+  DmdStats stats;
+  uint64_t cyclesRow = 0;
+  uint32_t cntRows = 0;
+
+  dmd.Initialise();
+  dmd.Start();
+
+  // Settle into the scan, then count the writes of a refresh worth of rows, each from one latch to the next
+  CHECK(hostRunLatches(DmdScan * dmd.GetPlanes()));
+  hostPanel.isCountingRows = true;
+  CHECK(hostRunLatches(DmdScan * dmd.GetPlanes()));
+  hostPanel.isCountingRows = false;
+
+  uint32_t cntWrites = 0;
+
+  for(const HostCounts& counts : hostPanel.rows)
+  {
+    cntWrites = max(cntWrites, counts.cntPinWrites + counts.cntPortWrites);
+  }
+
+  // A second's profile of the rows, all of the isr's cycles on the fake clock
+  hostRunMicros(1100000);
+  dmd.GetStats(stats);
+  for(int plane = 0; plane < stats.cntPlanes; plane++)
+  {
+    cyclesRow += stats.planes[plane].cyclesTotal;
+    cntRows += stats.planes[plane].cntRows;
+  }
+  if(!CHECK(cntRows > 0))
+  {
+    return hostReport("TestRowKernel");
+  }
+  cyclesRow /= cntRows;
+
+  // The old updates' pin writes alone, at the same cost a write, their masking and compares for nothing
+  RowOps old = modelOldRow(dmd.GetBrightness());
+  uint64_t cyclesOld = (uint64_t)old.cntPinWrites * hostConfig.cyclesPinWrite;
+
+  printf("%dx%d row: old %u pin writes and %u other operations, %llu cycles or more, new %u writes, %llu cycles\n",
+    DmdWidth, DmdHeight, old.cntPinWrites, old.cntOther, (unsigned long long)cyclesOld, cntWrites, (unsigned long long)cyclesRow);
+
+  CHECK(cntWrites <= old.cntPinWrites);
+  CHECK(cyclesRow <= cyclesOld);
+
+  dmd.Stop();
+
+  return hostReport("TestRowKernel");
+}
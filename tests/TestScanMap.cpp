@@ -0,0 +1,104 @@
+#include "Host.h"
+
+// Frames round-tripped through the scan map, presented and scanned out to a panel wired as the scan
+// descriptor says, then read back off the panel's latched rows
+
+//-----------------
+// Function: wiring
+//-----------------
+static void wiring(int address, int dotsX[DmdScanPulses], int dotsY[DmdScanPulses])
+{
+  const int cntBlocks = DmdChainWidth / DmdScanOrder::block;
+  int pulse = 0;
+
+  // Walk the chain as the panel lays it out, block by block, each row of the address taking its turn
+  for(int turn = 0; turn < cntBlocks; turn++)
+  {
+    int xBlock = (DmdScanOrder::blockOrder == DmdBlocksRightFirst ? cntBlocks - 1 - turn : turn) * DmdScanOrder::block;
+    bool isBottomFirst = (DmdScanOrder::rowOrder == DmdRowsBottomFirst || (DmdScanOrder::rowOrder == DmdRowsAlternate && (turn & 0x01)));
+
+    for(int rowTurn = 0; rowTurn < DmdScanRows; rowTurn++)
+    {
+      int row = (isBottomFirst ? DmdScanRows - 1 - rowTurn : rowTurn);
+
+      for(int dot = 0; dot < DmdScanOrder::block; dot++, pulse++)
+      {
+        dotsX[pulse] = xBlock + dot;
+        dotsY[pulse] = address + (row * DmdScan);
+      }
+    }
+  }
+}
+
+static DmdFrame expected;
+
+int main()
+{
+  uint32_t seed = 7;
+
+  // Port stores for free, the longest chains' rows would otherwise outrun the shortest planes
+  hostConfig.cyclesPortWrite = 0;
+
+  dmd.Initialise();
+  dmd.Start();
+
+  for(int pass = 0; pass < 3; pass++)
+  {
+    DmdFrame& frame = dmd.AcquireBackBuffer();
+
+    // Dots fully on or off, so any plane shows them
+    for(int y = 0; y < DmdHeight; y++)
+    {
+      for(int x = 0; x < DmdWidth; x++)
+      {
+        seed = (seed * 1103515245) + 12345;
+        expected.SetDot(x, y, (seed >> 16) & 0x01 ? 0x0F : 0x00);
+      }
+    }
+    for(int y = 0; y < DmdHeight; y++)
+    {
+      for(int x = 0; x < DmdWidth; x++)
+      {
+        frame.SetDot(x, y, expected.GetDot(x, y));
+      }
+    }
+    CHECK(dmd.Present());
+
+    // Take it up and scan it out whole
+    CHECK(hostRunLatches(DmdScan * DmdPlanesMax * 4));
+
+    // Red lanes of each chain's top and bottom half, dots land where the wiring puts their pulse
+    for(int address = 0; address < DmdScan; address++)
+    {
+      int dotsX[DmdScanPulses];
+      int dotsY[DmdScanPulses];
+
+      wiring(address, dotsX, dotsY);
+      for(int chain = 0; chain < DmdChains; chain++)
+      {
+        int xChain = DmdChainsStacked ? 0 : chain * DmdChainWidth;
+        int yChain = DmdChainsStacked ? chain * DmdChainHeight : 0;
+
+        for(int pulse = 0; pulse < DmdScanPulses; pulse++)
+        {
+          DmdLaneCode lanes = hostPanel.latched[address][pulse] >> (chain * DmdLanesChain);
+          int x = xChain + dotsX[pulse];
+          int y = yChain + dotsY[pulse];
+
+          if(!CHECK(((lanes & DmdLaneR1) != 0) == (expected.GetDot(x, y) != 0)) ||
+             !CHECK(((lanes & DmdLaneR2) != 0) == (expected.GetDot(x, y + (DmdChainHeight / 2)) != 0)))
+          {
+            printf("pass %d address %d pulse %d chain %d\n", pass, address, pulse, chain);
+            return hostReport("TestScanMap");
+          }
+        }
+      }
+    }
+  }
+
+  CHECK(hostPanel.cntGlitches == 0);
+  CHECK(hostPanel.cntSetupViolations == 0);
+  dmd.Stop();
+
+  return hostReport("TestScanMap");
+}
@@ -0,0 +1,82 @@
+#ifndef __ARDUINO_H__
+#define __ARDUINO_H__
+
+// Host stand-in for the Teensy core, just what the Dmd driver, frames and dotmaps use
+// Time is a fake cycle clock the host harness advances, pins and ports feed its panel model
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+// Teensy 3.6 clocks
+#define F_CPU 180000000
+#define F_BUS 60000000
+
+// Cycle counter, each read moves the fake clock on a cycle
+uint32_t hostCycleCount();
+extern uint32_t hostDemcr;
+extern uint32_t hostDwtCtrl;
+
+#define ARM_DWT_CYCCNT (hostCycleCount())
+#define ARM_DEMCR hostDemcr
+#define ARM_DEMCR_TRCENA (1 << 24)
+#define ARM_DWT_CTRL hostDwtCtrl
+#define ARM_DWT_CTRL_CYCCNTENA (1 << 0)
+
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t msec);
+void delayMicroseconds(uint32_t usec);
+void yield();
+
+void noInterrupts();
+void interrupts();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// Every pin write goes to the host harness, counted and fed to the panel model
+void hostPinWrite(uint8_t pin, uint8_t value);
+
+static inline void digitalWriteFast(uint8_t pin, uint8_t value)
+{
+  hostPinWrite(pin, value);
+}
+
+// Whole-port set and clear registers as on Teensy 4.x, eight pins a port
+volatile uint32_t *portSetRegister(uint8_t pin);
+volatile uint32_t *portClearRegister(uint8_t pin);
+uint32_t digitalPinToBitMask(uint8_t pin);
+
+// Port stores of the scanout go to the host harness too
+void hostPortWrite(volatile uint32_t *reg, uint32_t value);
+
+#define DMD_PORT_WRITE(reg, value) hostPortWrite(reg, value)
+
+template<class A, class B> static inline auto min(A a, B b) -> decltype(a + b)
+{
+  return a < b ? a : b;
+}
+
+template<class A, class B> static inline auto max(A a, B b) -> decltype(a + b)
+{
+  return a > b ? a : b;
+}
+
+// Teensy core headers pull in the timers
+#include <IntervalTimer.h>
+
+#endif
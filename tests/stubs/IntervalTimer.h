@@ -0,0 +1,46 @@
+#ifndef __INTERVALTIMER_H__
+#define __INTERVALTIMER_H__
+
+#include <stdint.h>
+
+// Host stand-in for a Teensy 3.x PIT channel, run by the host harness off the fake cycle clock
+// Like the PIT, a period set by update() is taken as the reload after the one running
+class IntervalTimer
+{
+  public:
+    // Shortest period the PIT takes, 36 bus cycles
+    static constexpr double microsMin = 36.0 / 60.0;
+
+    IntervalTimer();
+    ~IntervalTimer();
+
+    template<class Period> bool begin(void (*funct)(), Period microseconds)
+    {
+      return Begin(funct, (double)microseconds);
+    }
+
+    template<class Period> void update(Period microseconds)
+    {
+      Update((double)microseconds);
+    }
+
+    void end();
+    void priority(uint8_t level);
+
+    // Harness side
+    bool Begin(void (*funct)(), double microseconds);
+    void Update(double microseconds);
+
+    void (*funct)();
+    bool isActive;
+    uint8_t level;
+    uint64_t cyclesDue;
+    uint64_t cyclesReload;
+    uint32_t cntBegins;
+    uint32_t cntUpdates;
+    uint32_t cntEnds;
+    uint32_t cntFires;
+    uint32_t cntIrqOffCalls;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __SDFAT_H__
+#define __SDFAT_H__
+
+#include <Arduino.h>
+
+// Host stand-in for an SdFat file, reads from a buffer in memory
+class FsFile
+{
+  public:
+    const byte *data = NULL;
+    size_t size = 0;
+    size_t position = 0;
+
+    int read(void *buf, size_t count)
+    {
+      count = min(count, size - position);
+      memcpy(buf, data + position, count);
+      position += count;
+
+      return (int)count;
+    }
+};
+
+class SdFs;
+
+#endif